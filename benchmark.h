@@ -0,0 +1,287 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+// Общий каркас для замеров времени во всех программах openmpN.cpp.
+// Каждое ядро регистрируется через BenchmarkRunner::run: сначала выполняются
+// прогревочные запуски (холодные кэши, запуск пула потоков), затем число
+// повторов подбирается так, чтобы суммарное время было не меньше min_time.
+// Результаты можно сохранить в CSV/JSON для автоматического сравнения.
+
+// Параметры запуска, задаются из командной строки:
+//   --warmup=N --min-repeats=N --max-repeats=N --min-time=SEC
+//   --csv=FILE --json=FILE
+struct BenchmarkOptions {
+    int warmup = 2;
+    int min_repeats = 5;
+    int max_repeats = 100;
+    double min_time = 0.2;
+    std::string csv_path;
+    std::string json_path;
+};
+
+// Статистика по времени одного ядра (в секундах)
+struct BenchmarkStats {
+    int repeats = 0;
+    double min = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+    double mean = 0.0;
+    double stddev = 0.0;
+};
+
+// Набор параметров запуска ядра: размер, число потоков, вариант и т.п.
+using BenchmarkParams = std::vector<std::pair<std::string, std::string>>;
+
+// Не даёт компилятору выбросить вычисление value, результат которого
+// дальше не используется (для скалярных типов)
+template <typename T>
+inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    const volatile T* sink = &value;
+    (void)*sink;
+#endif
+}
+
+// Значение аргумента вида --name=value (или default_value, если его нет)
+inline std::string get_option(int argc, char* argv[], const std::string& name, const std::string& default_value) {
+    std::string prefix = "--" + name + "=";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.compare(0, prefix.size(), prefix) == 0) {
+            return arg.substr(prefix.size());
+        }
+    }
+    return default_value;
+}
+
+// Разбор списка вида "1,2,4,8"
+inline std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == std::string::npos) comma = text.size();
+        if (comma > pos) values.push_back(std::atoi(text.substr(pos, comma - pos).c_str()));
+        pos = comma + 1;
+    }
+    return values;
+}
+
+// Положительное целое без знака и посторонних символов
+inline bool parse_positive(const std::string& text, size_t& value) {
+    if (text.empty() || text[0] < '0' || text[0] > '9') return false;
+    char* end = nullptr;
+    unsigned long long parsed = std::strtoull(text.c_str(), &end, 10);
+    if (*end != '\0' || parsed == 0) return false;
+    value = static_cast<size_t>(parsed);
+    return true;
+}
+
+// Список положительных целых вида "2,8,32"; false, если хоть одно значение
+// не положительное целое (или не помещается в int)
+inline bool parse_positive_list(const std::string& text, std::vector<int>& values) {
+    values.clear();
+    size_t pos = 0;
+    while (pos <= text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == std::string::npos) comma = text.size();
+        size_t value = 0;
+        if (!parse_positive(text.substr(pos, comma - pos), value) ||
+            value > static_cast<size_t>(std::numeric_limits<int>::max())) {
+            return false;
+        }
+        values.push_back(static_cast<int>(value));
+        pos = comma + 1;
+    }
+    return true;
+}
+
+// Разбор списка вида "static,dynamic,guided"
+inline std::vector<std::string> parse_string_list(const std::string& text) {
+    std::vector<std::string> values;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t comma = text.find(',', pos);
+        if (comma == std::string::npos) comma = text.size();
+        if (comma > pos) values.push_back(text.substr(pos, comma - pos));
+        pos = comma + 1;
+    }
+    return values;
+}
+
+inline BenchmarkOptions parse_benchmark_options(int argc, char* argv[], BenchmarkOptions options = BenchmarkOptions()) {
+    options.warmup = std::atoi(get_option(argc, argv, "warmup", std::to_string(options.warmup)).c_str());
+    options.min_repeats = std::atoi(get_option(argc, argv, "min-repeats", std::to_string(options.min_repeats)).c_str());
+    options.max_repeats = std::atoi(get_option(argc, argv, "max-repeats", std::to_string(options.max_repeats)).c_str());
+    options.min_time = std::atof(get_option(argc, argv, "min-time", std::to_string(options.min_time)).c_str());
+    options.csv_path = get_option(argc, argv, "csv", options.csv_path);
+    options.json_path = get_option(argc, argv, "json", options.json_path);
+    options.min_repeats = std::max(options.min_repeats, 1);
+    options.max_repeats = std::max(options.max_repeats, options.min_repeats);
+    return options;
+}
+
+// Подсчёт статистики по списку замеров
+inline BenchmarkStats compute_stats(std::vector<double> samples) {
+    BenchmarkStats stats;
+    if (samples.empty()) return stats;
+    std::sort(samples.begin(), samples.end());
+
+    size_t n = samples.size();
+    stats.repeats = static_cast<int>(n);
+    stats.min = samples.front();
+    stats.median = (n % 2 == 1) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    size_t p95_index = static_cast<size_t>(std::ceil(0.95 * n)) - 1;
+    stats.p95 = samples[std::min(p95_index, n - 1)];
+
+    double sum = 0.0;
+    for (double s : samples) sum += s;
+    stats.mean = sum / n;
+
+    double sq = 0.0;
+    for (double s : samples) sq += (s - stats.mean) * (s - stats.mean);
+    stats.stddev = (n > 1) ? std::sqrt(sq / (n - 1)) : 0.0;
+    return stats;
+}
+
+class BenchmarkRunner {
+public:
+    BenchmarkRunner(const std::string& suite, const BenchmarkOptions& options)
+        : suite_(suite), options_(options) {}
+
+    ~BenchmarkRunner() {
+        write_reports();
+    }
+
+    const BenchmarkOptions& options() const { return options_; }
+
+    // Запуск ядра: прогрев, затем замеры до min_time (от min_repeats до max_repeats раз)
+    template <typename Body>
+    BenchmarkStats run(const std::string& kernel, const BenchmarkParams& params, Body&& body) {
+        for (int w = 0; w < options_.warmup; ++w) {
+            body();
+        }
+
+        std::vector<double> samples;
+        double elapsed = 0.0;
+        while (static_cast<int>(samples.size()) < options_.max_repeats &&
+               (static_cast<int>(samples.size()) < options_.min_repeats || elapsed < options_.min_time)) {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            double duration = std::chrono::duration<double>(end - start).count();
+            samples.push_back(duration);
+            elapsed += duration;
+        }
+
+        return record(kernel, params, samples);
+    }
+
+    // Сохранение уже измеренных замеров (для ядер, которые считают время сами)
+    BenchmarkStats record(const std::string& kernel, const BenchmarkParams& params, const std::vector<double>& samples) {
+        Record rec;
+        rec.kernel = kernel;
+        rec.params = params;
+        rec.stats = compute_stats(samples);
+        records_.push_back(rec);
+        return rec.stats;
+    }
+
+    void write_reports() {
+        if (written_) return;
+        written_ = true;
+        if (!options_.csv_path.empty()) write_csv(options_.csv_path);
+        if (!options_.json_path.empty()) write_json(options_.json_path);
+    }
+
+private:
+    struct Record {
+        std::string kernel;
+        BenchmarkParams params;
+        BenchmarkStats stats;
+    };
+
+    static std::string json_escape(const std::string& text) {
+        std::string out;
+        for (char c : text) {
+            if (c == '"' || c == '\\') out += '\\';
+            out += c;
+        }
+        return out;
+    }
+
+    static std::string csv_escape(const std::string& text) {
+        if (text.find_first_of(",\"") == std::string::npos) return text;
+        std::string out = "\"";
+        for (char c : text) {
+            if (c == '"') out += '"';
+            out += c;
+        }
+        return out + "\"";
+    }
+
+    // Параметры разных ядер могут отличаться, поэтому в CSV они пишутся
+    // одним столбцом вида key=value;key=value
+    void write_csv(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << path << " for writing!" << std::endl;
+            return;
+        }
+        file.precision(9);
+        file << "suite,kernel,params,repeats,min,median,p95,mean,stddev\n";
+        for (const Record& rec : records_) {
+            std::string params;
+            for (const auto& p : rec.params) {
+                if (!params.empty()) params += ';';
+                params += p.first + "=" + p.second;
+            }
+            file << csv_escape(suite_) << ',' << csv_escape(rec.kernel) << ',' << csv_escape(params) << ','
+                 << rec.stats.repeats << ',' << rec.stats.min << ',' << rec.stats.median << ','
+                 << rec.stats.p95 << ',' << rec.stats.mean << ',' << rec.stats.stddev << '\n';
+        }
+    }
+
+    void write_json(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open " << path << " for writing!" << std::endl;
+            return;
+        }
+        file.precision(9);
+        file << "{\n  \"suite\": \"" << json_escape(suite_) << "\",\n  \"results\": [\n";
+        for (size_t i = 0; i < records_.size(); ++i) {
+            const Record& rec = records_[i];
+            file << "    {\"kernel\": \"" << json_escape(rec.kernel) << "\", \"params\": {";
+            for (size_t j = 0; j < rec.params.size(); ++j) {
+                if (j > 0) file << ", ";
+                file << '"' << json_escape(rec.params[j].first) << "\": \"" << json_escape(rec.params[j].second) << '"';
+            }
+            file << "}, \"repeats\": " << rec.stats.repeats
+                 << ", \"min\": " << rec.stats.min
+                 << ", \"median\": " << rec.stats.median
+                 << ", \"p95\": " << rec.stats.p95
+                 << ", \"mean\": " << rec.stats.mean
+                 << ", \"stddev\": " << rec.stats.stddev << '}'
+                 << (i + 1 < records_.size() ? ",\n" : "\n");
+        }
+        file << "  ]\n}\n";
+    }
+
+    std::string suite_;
+    BenchmarkOptions options_;
+    std::vector<Record> records_;
+    bool written_ = false;
+};
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+
+// Генератор случайных чисел "по счётчику": значение зависит только от
+// (seed, counter), общего состояния нет. Поэтому его можно вызывать из любого
+// потока без блокировок, и результат не зависит от числа потоков и порядка
+// выполнения итераций (в отличие от rand() с глобальным состоянием).
+
+// Финализатор SplitMix64 - хорошо перемешивающая биекция 64-битных чисел
+inline uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// Случайное 64-битное число номер counter в потоке seed
+inline uint64_t counter_random(uint64_t seed, uint64_t counter) {
+    return splitmix64(splitmix64(seed) ^ counter);
+}
+
+// Равномерное число в [0, 1)
+inline double counter_uniform(uint64_t seed, uint64_t counter) {
+    return (counter_random(seed, counter) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Равномерное целое в [low, high]
+inline int counter_int(uint64_t seed, uint64_t counter, int low, int high) {
+    uint64_t range = static_cast<uint64_t>(high - low) + 1;
+    return low + static_cast<int>(counter_random(seed, counter) % range);
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>
+#include <cstddef>
+#include <omp.h>
+#include "benchmark.h"
+#include "counter_rng.h"
+#include "matrix.h"
+
+// Генерация входных данных для программ: параллельно, по счётчиковому
+// генератору из counter_rng.h. Элемент номер i зависит только от (seed, i),
+// поэтому данные побитово совпадают при любом числе потоков и между запусками
+// с одинаковым --seed, а заполнение масштабируется вместе с потоками
+// (в отличие от последовательного rand()).
+
+// Зерно данных: --seed=N (по умолчанию 1)
+inline uint64_t parse_data_seed(int argc, char* argv[]) {
+    return std::strtoull(get_option(argc, argv, "seed", "1").c_str(), nullptr, 10);
+}
+
+// data[i] = value(i) для i из [0, n)
+template <typename T, typename Value>
+void parallel_fill(T* data, size_t n, Value&& value) {
+    long long count = static_cast<long long>(n);
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < count; ++i) {
+        data[i] = value(static_cast<uint64_t>(i));
+    }
+}
+
+// Вектор равномерно распределённых целых из [low, high]
+inline void fill_uniform_ints(std::vector<int>& data, int low, int high, uint64_t seed) {
+    parallel_fill(data.data(), data.size(), [=](uint64_t i) { return counter_int(seed, i, low, high); });
+}
+
+// matrix(i, j) = value(i, j) для всех элементов или только для j из
+// [first_col(i), end_col(i)) (остальные не трогаются). Индекс генератора -
+// i * cols + j, он не зависит от выравнивания строк (stride)
+template <typename T, typename Value, typename First, typename End>
+void parallel_fill_rows(Matrix<T>& matrix, Value&& value, First&& first_col, End&& end_col) {
+    long long rows = static_cast<long long>(matrix.rows());
+    #pragma omp parallel for schedule(static)
+    for (long long i = 0; i < rows; ++i) {
+        RowView<T> row = matrix.row(i);
+        for (size_t j = first_col(i); j < end_col(i); ++j) {
+            row[j] = value(static_cast<uint64_t>(i) * matrix.cols() + j);
+        }
+    }
+}
+
+template <typename T>
+void fill_uniform_ints(Matrix<T>& matrix, int low, int high, uint64_t seed) {
+    parallel_fill_rows(matrix, [=](uint64_t k) { return static_cast<T>(counter_int(seed, k, low, high)); },
+                       [](size_t) { return size_t(0); }, [&](size_t) { return matrix.cols(); });
+}
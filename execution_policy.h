@@ -0,0 +1,112 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <omp.h>
+#include "benchmark.h"
+
+// Политика выполнения ядра: сколько потоков брать на вызов с задачей из n
+// элементов. Модель: T(p) = n * c / p + o * p, где c - последовательная
+// стоимость элемента, o - стоимость параллельной области с редукцией в
+// пересчёте на поток. openmp10 печатает пороги по модели n * c / p + O(p)
+// со стоимостью области O(p), измеренной отдельно для каждого p; здесь O(p)
+// приближается линейно, o * p (по одному замеру на max_threads потоках),
+// чтобы у T(p) был минимум: p* = sqrt(n * c / o). Параллельная версия
+// выигрывает у последовательной уже на двух потоках только при
+// n * c / 2 + 2 * o < n * c, то есть n * c > 4 * o - это и есть порог cutoff.
+// Задачи меньше порога выполняются одним потоком: ядра пишутся с
+// if(threads > 1), и команда не будит потоки.
+//
+// Команда потоков создаётся один раз, при калибровке, на max_threads потоков.
+// libgomp и libomp держат её потоки между областями, а области с
+// num_threads(p), p <= max_threads, берут потоки из неё, поэтому ядра задают
+// число потоков клаузой num_threads, без omp_set_num_threads в каждом вызове.
+struct ExecutionPolicy {
+    std::string kernel;
+    double ns_per_element = 0.0;
+    double overhead_ns_per_thread = 0.0;
+    size_t cutoff = 0;
+    bool fixed = false;  // --policy=fixed: всегда запрошенное число потоков
+
+    // Число потоков для задачи из n элементов, не больше requested
+    int threads_for(size_t n, int requested) const {
+        if (fixed || requested <= 1) return std::max(1, requested);
+        if (n < cutoff) return 1;
+        int best = static_cast<int>(std::sqrt(n * ns_per_element / overhead_ns_per_thread));
+        return std::max(2, std::min(best, requested));
+    }
+};
+
+// Стоимость входа в параллельную область с редукцией на один поток команды
+// из max_threads потоков (нс). Первый же замер создаёт эту команду;
+// результат запоминается, чтобы все ядра программы калибровались по одной оценке
+inline double region_overhead_per_thread_ns(int max_threads) {
+    static int measured_threads = 0;
+    static double overhead = 0.0;
+    if (measured_threads == max_threads) return overhead;
+
+    const int reps = 200;
+    double best = std::numeric_limits<double>::infinity();
+    long long sum = 0;
+    for (int batch = 0; batch < 5; ++batch) {
+        double start = omp_get_wtime();
+        for (int r = 0; r < reps; ++r) {
+            #pragma omp parallel num_threads(max_threads) reduction(+:sum)
+            sum += 1;
+        }
+        best = std::min(best, (omp_get_wtime() - start) / reps);
+    }
+    do_not_optimize(sum);
+
+    measured_threads = max_threads;
+    overhead = std::max(1.0, best * 1e9 / max_threads);
+    return overhead;
+}
+
+// Последовательная стоимость элемента (нс): лучший из нескольких прогонов
+// run_sample(), который обрабатывает sample_size элементов одним потоком
+template <typename Sample>
+double measure_ns_per_element(size_t sample_size, Sample&& run_sample) {
+    run_sample();
+    double best = std::numeric_limits<double>::infinity();
+    for (int r = 0; r < 5; ++r) {
+        double start = omp_get_wtime();
+        run_sample();
+        best = std::min(best, omp_get_wtime() - start);
+    }
+    return best * 1e9 / sample_size;
+}
+
+// Калибровка политики ядра kernel. --policy=fixed отключает выбор числа
+// потоков (прежнее поведение), --cutoff=N задаёт порог вместо измеренного
+template <typename Sample>
+ExecutionPolicy make_execution_policy(int argc, char* argv[], const std::string& kernel, int max_threads,
+                                      size_t sample_size, Sample&& run_sample) {
+    ExecutionPolicy policy;
+    policy.kernel = kernel;
+    policy.fixed = get_option(argc, argv, "policy", "auto") == "fixed";
+    policy.overhead_ns_per_thread = region_overhead_per_thread_ns(max_threads);
+    if (policy.fixed) return policy;
+
+    policy.ns_per_element = std::max(1e-3, measure_ns_per_element(sample_size, run_sample));
+    std::string cutoff = get_option(argc, argv, "cutoff", "");
+    policy.cutoff = cutoff.empty() ? static_cast<size_t>(4 * policy.overhead_ns_per_thread / policy.ns_per_element)
+                                   : std::strtoull(cutoff.c_str(), nullptr, 10);
+    return policy;
+}
+
+inline void print_execution_policy(const ExecutionPolicy& policy) {
+    std::cout << "Policy " << policy.kernel << ": ";
+    if (policy.fixed) {
+        std::cout << "fixed (requested thread count)\n";
+        return;
+    }
+    std::cout << "serial below " << policy.cutoff << " elements ("
+              << policy.ns_per_element << " ns/element, region "
+              << policy.overhead_ns_per_thread << " ns/thread)\n";
+}
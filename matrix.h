@@ -0,0 +1,106 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <memory>
+#include <utility>
+
+// Непрерывная строка матрицы (указатель + длина), поддерживает range-for
+template <typename T>
+class RowView {
+public:
+    RowView(T* data, size_t size) : data_(data), size_(size) {}
+
+    T* data() const { return data_; }
+    size_t size() const { return size_; }
+    T* begin() const { return data_; }
+    T* end() const { return data_ + size_; }
+    T& operator[](size_t j) const { return data_[j]; }
+
+private:
+    T* data_;
+    size_t size_;
+};
+
+// Матрица в построчном (row-major) формате в одном выделении памяти.
+// Длина строки дополняется до кратной кэш-линии (stride), поэтому каждая
+// строка начинается с границы кэш-линии, а соседние строки лежат подряд
+// и аппаратная предвыборка работает по всей матрице.
+template <typename T>
+class Matrix {
+public:
+    static const size_t alignment = 64;
+
+    Matrix() : rows_(0), cols_(0), stride_(0), data_(nullptr) {}
+
+    Matrix(size_t rows, size_t cols, const T& value = T())
+        : rows_(rows), cols_(cols), stride_(padded_stride(cols)), data_(nullptr) {
+        size_t count = rows_ * stride_;
+        if (count > 0) {
+            data_ = static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(alignment)));
+            std::uninitialized_fill(data_, data_ + count, value);
+        }
+    }
+
+    Matrix(Matrix&& other) noexcept
+        : rows_(other.rows_), cols_(other.cols_), stride_(other.stride_), data_(other.data_) {
+        other.rows_ = other.cols_ = other.stride_ = 0;
+        other.data_ = nullptr;
+    }
+
+    Matrix& operator=(Matrix&& other) noexcept {
+        if (this != &other) {
+            release();
+            rows_ = other.rows_;
+            cols_ = other.cols_;
+            stride_ = other.stride_;
+            data_ = other.data_;
+            other.rows_ = other.cols_ = other.stride_ = 0;
+            other.data_ = nullptr;
+        }
+        return *this;
+    }
+
+    Matrix(const Matrix&) = delete;
+    Matrix& operator=(const Matrix&) = delete;
+
+    ~Matrix() {
+        release();
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t stride() const { return stride_; }
+    size_t size() const { return rows_; }
+    size_t memory_bytes() const { return rows_ * stride_ * sizeof(T); }
+
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+
+    T& operator()(size_t i, size_t j) { return data_[i * stride_ + j]; }
+    const T& operator()(size_t i, size_t j) const { return data_[i * stride_ + j]; }
+
+    RowView<T> row(size_t i) { return RowView<T>(data_ + i * stride_, cols_); }
+    RowView<const T> row(size_t i) const { return RowView<const T>(data_ + i * stride_, cols_); }
+    RowView<T> operator[](size_t i) { return row(i); }
+    RowView<const T> operator[](size_t i) const { return row(i); }
+
+private:
+    static size_t padded_stride(size_t cols) {
+        size_t per_line = alignment / sizeof(T);
+        if (per_line == 0) return cols;
+        return (cols + per_line - 1) / per_line * per_line;
+    }
+
+    void release() {
+        if (data_ == nullptr) return;
+        std::destroy(data_, data_ + rows_ * stride_);
+        ::operator delete(data_, std::align_val_t(alignment));
+        data_ = nullptr;
+    }
+
+    size_t rows_;
+    size_t cols_;
+    size_t stride_;
+    T* data_;
+};
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <string>
+#include <new>
+#include <cstdlib>
+#include <cstddef>
+#include <omp.h>
+#include "benchmark.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// Массив, страницы которого "первым касанием" инициализируются параллельно
+// с тем же статическим распределением, что и вычислительный цикл
+// (schedule(static)). Тогда каждая страница оказывается на NUMA-узле того
+// потока, который потом её читает, а не на узле главного потока.
+template <typename T>
+class NumaArray {
+public:
+    static const size_t page_size = 4096;
+
+    NumaArray(size_t size, const T& value, bool parallel_init = true)
+        : size_(size),
+          data_(static_cast<T*>(::operator new(size * sizeof(T), std::align_val_t(page_size)))) {
+        T* data = data_;
+        long long n = static_cast<long long>(size);
+        if (parallel_init) {
+            #pragma omp parallel for schedule(static)
+            for (long long i = 0; i < n; ++i) {
+                new (data + i) T(value);
+            }
+        } else {
+            for (long long i = 0; i < n; ++i) {
+                new (data + i) T(value);
+            }
+        }
+    }
+
+    ~NumaArray() {
+        for (size_t i = 0; i < size_; ++i) {
+            data_[i].~T();
+        }
+        ::operator delete(data_, std::align_val_t(page_size));
+    }
+
+    NumaArray(const NumaArray&) = delete;
+    NumaArray& operator=(const NumaArray&) = delete;
+
+    size_t size() const { return size_; }
+    T* data() { return data_; }
+    const T* data() const { return data_; }
+    T& operator[](size_t i) { return data_[i]; }
+    const T& operator[](size_t i) const { return data_[i]; }
+
+private:
+    size_t size_;
+    T* data_;
+};
+
+// Закрепление потоков: --bind=close|spread|master и --places=cores|threads|sockets.
+// OMP_PROC_BIND и OMP_PLACES читаются рантаймом при загрузке, поэтому
+// переменные окружения выставляются и программа перезапускается.
+inline void apply_thread_binding(int argc, char* argv[]) {
+    std::string bind = get_option(argc, argv, "bind", "");
+    std::string places = get_option(argc, argv, "places", bind.empty() ? "" : "cores");
+    if (bind.empty()) return;
+
+    const char* current_bind = std::getenv("OMP_PROC_BIND");
+    const char* current_places = std::getenv("OMP_PLACES");
+    if (current_bind && bind == current_bind && current_places && places == current_places) return;
+
+#if defined(__unix__) || defined(__APPLE__)
+    setenv("OMP_PROC_BIND", bind.c_str(), 1);
+    setenv("OMP_PLACES", places.c_str(), 1);
+    execv("/proc/self/exe", argv);
+    execvp(argv[0], argv);
+#endif
+    std::cerr << "Failed to apply thread binding, set OMP_PROC_BIND=" << bind
+              << " OMP_PLACES=" << places << " manually" << std::endl;
+}
+
+// Печать фактического размещения потоков команды
+inline void print_thread_placement(int num_threads) {
+    std::vector<int> places(num_threads, -1);
+    std::vector<int> cpus(num_threads, -1);
+    int proc_bind = omp_get_proc_bind();
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int t = omp_get_thread_num();
+        places[t] = omp_get_place_num();
+#ifdef __linux__
+        cpus[t] = sched_getcpu();
+#endif
+    }
+
+    static const char* bind_names[] = {"false", "true", "master", "close", "spread"};
+    std::cout << "Threads: " << num_threads
+              << " | OMP_PROC_BIND: " << (proc_bind >= 0 && proc_bind <= 4 ? bind_names[proc_bind] : "?")
+              << " | places: " << omp_get_num_places() << "\n";
+    for (int t = 0; t < num_threads; ++t) {
+        std::cout << "  thread " << t << " -> place " << places[t];
+        if (cpus[t] >= 0) std::cout << ", cpu " << cpus[t];
+        std::cout << "\n";
+    }
+}
@@ -4,65 +4,82 @@
 #include <limits>
 #include <iomanip>
 #include <cstdlib>
+#include <string>
+#include <algorithm>
+#include <cmath>
 #include <omp.h>
+#include "benchmark.h"
+#include "data_generator.h"
+#include "execution_policy.h"
+#include "statistics.h"
 
-using namespace std;
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MIN_MAX_X86_DISPATCH 1
+#endif
 
-// Функция для поиска минимума и максимума с использованием редукции
-void find_min_max_reduction(const vector<int>& vec, int num_threads, int num_repeats) {
-    int min_val = numeric_limits<int>::max();
-    int max_val = numeric_limits<int>::lowest();
+using namespace std;
 
-    // Установка количества потоков
-    omp_set_num_threads(num_threads);
+// Вывод строки таблицы с эффективной пропускной способностью памяти.
+// effective_threads - сколько потоков реально выполняли ядро (политика
+// выполнения может взять меньше запрошенных num_threads)
+void print_min_max_row(size_t size, int num_threads, int effective_threads, const BenchmarkStats& stats,
+                       int min_val, int max_val, const string& label) {
+    double bandwidth = size * sizeof(int) / stats.median / 1e9;
+    cout << setw(10) << size << " | "
+         << setw(10) << num_threads << " | "
+         << setw(9) << effective_threads << " | "
+         << setw(15) << stats.median << " s | "
+         << "Min: " << setw(10) << min_val << ", Max: " << setw(10) << max_val
+         << " | " << setw(8) << bandwidth << " GB/s"
+         << " (" << label << ")" << endl;
+}
 
-    double total_time = 0.0;
+// Политика выполнения min_max_reduction, калибруется в main
+ExecutionPolicy min_max_policy;
 
-    for (int r = 0; r < num_repeats; ++r) {
-        min_val = numeric_limits<int>::max();
-        max_val = numeric_limits<int>::lowest();
+// Поиск минимума и максимума параллельным циклом с reduction на threads потоках
+void min_max_reduction(const vector<int>& vec, int threads, int& min_val, int& max_val) {
+    min_val = numeric_limits<int>::max();
+    max_val = numeric_limits<int>::lowest();
 
-        // Начало измерения времени
-        auto start = chrono::high_resolution_clock::now();
+    #pragma omp parallel for num_threads(threads) if(threads > 1) reduction(min:min_val) reduction(max:max_val)
+    for (size_t i = 0; i < vec.size(); ++i) {
+        if (vec[i] < min_val) min_val = vec[i];
+        if (vec[i] > max_val) max_val = vec[i];
+    }
+}
 
-        // Параллельный цикл с reduction для обновления min_val и max_val
-        #pragma omp parallel for reduction(min:min_val) reduction(max:max_val)
-        for (size_t i = 0; i < vec.size(); ++i) {
-            if (vec[i] < min_val) min_val = vec[i];
-            if (vec[i] > max_val) max_val = vec[i];
-        }
+// Функция для поиска минимума и максимума с использованием редукции
+void find_min_max_reduction(const vector<int>& vec, int num_threads, BenchmarkRunner& runner) {
+    int min_val = numeric_limits<int>::max();
+    int max_val = numeric_limits<int>::lowest();
 
-        // Конец измерения времени
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> duration = end - start;
-        total_time += duration.count();
-    }
+    // Число потоков выбирается по размеру вектора, num_threads - верхняя граница
+    int threads = min_max_policy.threads_for(vec.size(), num_threads);
 
-    double average_time = total_time / num_repeats;
+    BenchmarkStats stats = runner.run("min_max_reduction",
+        {{"size", to_string(vec.size())}, {"threads", to_string(num_threads)},
+         {"effective_threads", to_string(threads)}}, [&]() {
+        min_max_reduction(vec, threads, min_val, max_val);
+    });
 
-    cout << setw(10) << vec.size() << " | "
-         << setw(10) << num_threads << " | "
-         << setw(15) << average_time << " s | "
-         << "Min: " << setw(10) << min_val << ", Max: " << setw(10) << max_val
-         << " (with reduction)" << endl;
+    print_min_max_row(vec.size(), num_threads, threads, stats, min_val, max_val, "with reduction");
 }
 
 // Функция для поиска минимума и максимума без использования редукции
-void find_min_max_no_reduction(const vector<int>& vec, int num_threads, int num_repeats) {
+void find_min_max_no_reduction(const vector<int>& vec, int num_threads, BenchmarkRunner& runner) {
     int min_val = numeric_limits<int>::max();
     int max_val = numeric_limits<int>::lowest();
 
     omp_set_num_threads(num_threads);
 
-    double total_time = 0.0;
-
-    for (int r = 0; r < num_repeats; ++r) {
+    BenchmarkStats stats = runner.run("min_max_no_reduction",
+        {{"size", to_string(vec.size())}, {"threads", to_string(num_threads)},
+         {"effective_threads", to_string(num_threads)}}, [&]() {
         min_val = numeric_limits<int>::max();
         max_val = numeric_limits<int>::lowest();
 
-        // Начало измерения времени
-        auto start = chrono::high_resolution_clock::now();
-
         #pragma omp parallel
         {
             int local_min = numeric_limits<int>::max();
@@ -82,42 +99,354 @@ void find_min_max_no_reduction(const vector<int>& vec, int num_threads, int num_
                 if (local_max > max_val) max_val = local_max;
             }
         }
+    });
+
+    print_min_max_row(vec.size(), num_threads, num_threads, stats, min_val, max_val, "without reduction");
+}
+
+// Поиск минимума и максимума через omp parallel for simd: без ветвлений,
+// поэтому компилятор может векторизовать цикл внутри каждого потока
+void find_min_max_simd(const vector<int>& vec, int num_threads, BenchmarkRunner& runner) {
+    int min_val = numeric_limits<int>::max();
+    int max_val = numeric_limits<int>::lowest();
+    const int* data = vec.data();
+    size_t size = vec.size();
+
+    omp_set_num_threads(num_threads);
+
+    BenchmarkStats stats = runner.run("min_max_simd",
+        {{"size", to_string(size)}, {"threads", to_string(num_threads)},
+         {"effective_threads", to_string(num_threads)}}, [&]() {
+        min_val = numeric_limits<int>::max();
+        max_val = numeric_limits<int>::lowest();
+
+        #pragma omp parallel for simd reduction(min:min_val) reduction(max:max_val)
+        for (size_t i = 0; i < size; ++i) {
+            min_val = min(min_val, data[i]);
+            max_val = max(max_val, data[i]);
+        }
+    });
+
+    print_min_max_row(size, num_threads, num_threads, stats, min_val, max_val, "omp simd");
+}
 
-        // Конец измерения времени
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> duration = end - start;
-        total_time += duration.count();
+// Переносимое ядро для одного потока (используется, если AVX недоступен)
+void min_max_kernel_scalar(const int* data, size_t n, int& min_out, int& max_out) {
+    int min_val = numeric_limits<int>::max();
+    int max_val = numeric_limits<int>::lowest();
+
+    #pragma omp simd reduction(min:min_val) reduction(max:max_val)
+    for (size_t i = 0; i < n; ++i) {
+        min_val = min(min_val, data[i]);
+        max_val = max(max_val, data[i]);
     }
 
-    double average_time = total_time / num_repeats;
+    min_out = min_val;
+    max_out = max_val;
+}
+
+#ifdef MIN_MAX_X86_DISPATCH
+// Ядро AVX2: четыре независимых аккумулятора, чтобы скрыть задержку vpminsd/vpmaxsd
+__attribute__((target("avx2")))
+void min_max_kernel_avx2(const int* data, size_t n, int& min_out, int& max_out) {
+    __m256i vmin0 = _mm256_set1_epi32(numeric_limits<int>::max());
+    __m256i vmax0 = _mm256_set1_epi32(numeric_limits<int>::lowest());
+    __m256i vmin1 = vmin0, vmin2 = vmin0, vmin3 = vmin0;
+    __m256i vmax1 = vmax0, vmax2 = vmax0, vmax3 = vmax0;
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 8));
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 16));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 24));
+        vmin0 = _mm256_min_epi32(vmin0, a); vmax0 = _mm256_max_epi32(vmax0, a);
+        vmin1 = _mm256_min_epi32(vmin1, b); vmax1 = _mm256_max_epi32(vmax1, b);
+        vmin2 = _mm256_min_epi32(vmin2, c); vmax2 = _mm256_max_epi32(vmax2, c);
+        vmin3 = _mm256_min_epi32(vmin3, d); vmax3 = _mm256_max_epi32(vmax3, d);
+    }
+    for (; i + 8 <= n; i += 8) {
+        __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        vmin0 = _mm256_min_epi32(vmin0, a);
+        vmax0 = _mm256_max_epi32(vmax0, a);
+    }
+    vmin0 = _mm256_min_epi32(_mm256_min_epi32(vmin0, vmin1), _mm256_min_epi32(vmin2, vmin3));
+    vmax0 = _mm256_max_epi32(_mm256_max_epi32(vmax0, vmax1), _mm256_max_epi32(vmax2, vmax3));
+
+    // Горизонтальная свёртка 8 элементов
+    alignas(32) int mins[8], maxs[8];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(mins), vmin0);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(maxs), vmax0);
+    int min_val = mins[0], max_val = maxs[0];
+    for (int k = 1; k < 8; ++k) {
+        min_val = min(min_val, mins[k]);
+        max_val = max(max_val, maxs[k]);
+    }
+
+    // Хвост
+    for (; i < n; ++i) {
+        min_val = min(min_val, data[i]);
+        max_val = max(max_val, data[i]);
+    }
+
+    min_out = min_val;
+    max_out = max_val;
+}
+
+// Ядро AVX-512 (в GCC заголовки с _mm512_undefined_epi32 дают ложные
+// предупреждения о неинициализированных значениях)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+__attribute__((target("avx512f")))
+void min_max_kernel_avx512(const int* data, size_t n, int& min_out, int& max_out) {
+    __m512i vmin0 = _mm512_set1_epi32(numeric_limits<int>::max());
+    __m512i vmax0 = _mm512_set1_epi32(numeric_limits<int>::lowest());
+    __m512i vmin1 = vmin0, vmax1 = vmax0;
+
+    size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        __m512i a = _mm512_loadu_si512(data + i);
+        __m512i b = _mm512_loadu_si512(data + i + 16);
+        vmin0 = _mm512_min_epi32(vmin0, a); vmax0 = _mm512_max_epi32(vmax0, a);
+        vmin1 = _mm512_min_epi32(vmin1, b); vmax1 = _mm512_max_epi32(vmax1, b);
+    }
+    vmin0 = _mm512_min_epi32(vmin0, vmin1);
+    vmax0 = _mm512_max_epi32(vmax0, vmax1);
 
+    // Хвост обрабатывается маскированной загрузкой
+    for (; i < n; i += 16) {
+        size_t rest = min<size_t>(n - i, 16);
+        __mmask16 mask = static_cast<__mmask16>((1u << rest) - 1);
+        __m512i a = _mm512_maskz_loadu_epi32(mask, data + i);
+        vmin0 = _mm512_mask_min_epi32(vmin0, mask, vmin0, a);
+        vmax0 = _mm512_mask_max_epi32(vmax0, mask, vmax0, a);
+    }
+
+    alignas(64) int mins[16], maxs[16];
+    _mm512_store_si512(mins, vmin0);
+    _mm512_store_si512(maxs, vmax0);
+    int min_val = mins[0], max_val = maxs[0];
+    for (int k = 1; k < 16; ++k) {
+        min_val = min(min_val, mins[k]);
+        max_val = max(max_val, maxs[k]);
+    }
+
+    min_out = min_val;
+    max_out = max_val;
+}
+#pragma GCC diagnostic pop
+#endif
+
+typedef void (*MinMaxKernel)(const int*, size_t, int&, int&);
+
+// Выбор ядра по возможностям процессора (или по имени из --isa=)
+MinMaxKernel select_min_max_kernel(const string& requested, string& isa_name) {
+#ifdef MIN_MAX_X86_DISPATCH
+    __builtin_cpu_init();
+    bool has_avx512 = __builtin_cpu_supports("avx512f");
+    bool has_avx2 = __builtin_cpu_supports("avx2");
+    if ((requested == "auto" || requested == "avx512") && has_avx512) {
+        isa_name = "avx512";
+        return min_max_kernel_avx512;
+    }
+    if ((requested == "auto" || requested == "avx512" || requested == "avx2") && has_avx2) {
+        isa_name = "avx2";
+        return min_max_kernel_avx2;
+    }
+#else
+    (void)requested;
+#endif
+    isa_name = "scalar";
+    return min_max_kernel_scalar;
+}
+
+// Поиск минимума и максимума с явными SIMD-ядрами: каждый поток обрабатывает
+// свой непрерывный блок, частичные результаты объединяются редукцией
+void find_min_max_vectorized(const vector<int>& vec, int num_threads, MinMaxKernel kernel, const string& isa_name, BenchmarkRunner& runner) {
+    int min_val = numeric_limits<int>::max();
+    int max_val = numeric_limits<int>::lowest();
+    const int* data = vec.data();
+    size_t size = vec.size();
+
+    omp_set_num_threads(num_threads);
+
+    BenchmarkStats stats = runner.run("min_max_" + isa_name,
+        {{"size", to_string(size)}, {"threads", to_string(num_threads)},
+         {"effective_threads", to_string(num_threads)}}, [&]() {
+        min_val = numeric_limits<int>::max();
+        max_val = numeric_limits<int>::lowest();
+
+        #pragma omp parallel reduction(min:min_val) reduction(max:max_val)
+        {
+            size_t thread = omp_get_thread_num();
+            size_t threads = omp_get_num_threads();
+            size_t begin = size * thread / threads;
+            size_t end = size * (thread + 1) / threads;
+
+            int local_min, local_max;
+            kernel(data + begin, end - begin, local_min, local_max);
+            min_val = min(min_val, local_min);
+            max_val = max(max_val, local_max);
+        }
+    });
+
+    print_min_max_row(size, num_threads, num_threads, stats, min_val, max_val, isa_name);
+}
+
+// Политика выполнения однопроходных статистик, калибруется в main
+ExecutionPolicy statistics_policy;
+
+// Те же статистики, что у compute_statistics, отдельными проходами - так, как
+// их считают существующие ядра: min/max (min_max_reduction), сумма (встроенная
+// редукция, как в openmp7), сумма квадратов отклонений от среднего (вторым
+// проходом) и поиск первых индексов минимума и максимума
+FusedStatistics<int> separate_statistics(const vector<int>& vec, int threads) {
+    FusedStatistics<int> stats;
+    const int* data = vec.data();
+    long long n = vec.size();
+    if (n == 0) return stats;
+    stats.count = vec.size();
+
+    min_max_reduction(vec, threads, stats.min, stats.max);
+
+    double sum = 0.0;
+    #pragma omp parallel for num_threads(threads) if(threads > 1) reduction(+:sum)
+    for (long long i = 0; i < n; ++i) {
+        sum += data[i];
+    }
+
+    double mean = sum / n;
+    double m2 = 0.0;
+    #pragma omp parallel for num_threads(threads) if(threads > 1) reduction(+:m2)
+    for (long long i = 0; i < n; ++i) {
+        double deviation = data[i] - mean;
+        m2 += deviation * deviation;
+    }
+
+    long long argmin = n;
+    long long argmax = n;
+    int min_val = stats.min;
+    int max_val = stats.max;
+    #pragma omp parallel for num_threads(threads) if(threads > 1) reduction(min:argmin, argmax)
+    for (long long i = 0; i < n; ++i) {
+        if (data[i] == min_val) argmin = min(argmin, i);
+        if (data[i] == max_val) argmax = min(argmax, i);
+    }
+
+    stats.sum = sum;
+    stats.running_mean = mean;
+    stats.m2 = m2;
+    stats.argmin = argmin;
+    stats.argmax = argmax;
+    return stats;
+}
+
+// Экстремумы, индексы и целая сумма должны совпадать точно; M2 обоих вариантов
+// складывается в разном порядке, поэтому сравнивается с относительным допуском
+bool same_statistics(const FusedStatistics<int>& a, const FusedStatistics<int>& b) {
+    return a.count == b.count && a.min == b.min && a.max == b.max && a.argmin == b.argmin &&
+           a.argmax == b.argmax && a.sum == b.sum &&
+           fabs(a.m2 - b.m2) <= 1e-9 * max(fabs(a.m2), fabs(b.m2));
+}
+
+// Режим --mode=fused: один проход compute_statistics против последовательного
+// запуска отдельных ядер. Целые суммы до 2^53 в double точны, поэтому суммы
+// обоих вариантов должны совпадать побитово, а M2 - с точностью до
+// округления (см. same_statistics). Возвращает false при несовпадении
+bool compare_fused_statistics(const vector<int>& vec, int num_threads, BenchmarkRunner& runner) {
+    int threads = statistics_policy.threads_for(vec.size(), num_threads);
+    BenchmarkParams params = {{"size", to_string(vec.size())}, {"threads", to_string(num_threads)},
+                              {"effective_threads", to_string(threads)}};
+    FusedStatistics<int> fused, separate;
+
+    double fused_time = runner.run("statistics_fused", params, [&]() {
+        fused = compute_statistics(vec.data(), vec.size(), threads);
+    }).median;
+    double separate_time = runner.run("statistics_separate", params, [&]() {
+        separate = separate_statistics(vec, threads);
+    }).median;
+
+    bool correct = same_statistics(fused, separate);
     cout << setw(10) << vec.size() << " | "
-         << setw(10) << num_threads << " | "
-         << setw(15) << average_time << " s | "
-         << "Min: " << setw(10) << min_val << ", Max: " << setw(10) << max_val
-         << " (without reduction)" << endl;
+         << setw(7) << num_threads << " | "
+         << setw(9) << threads << " | "
+         << setw(13) << fused_time << " | "
+         << setw(13) << separate_time << " | "
+         << setw(7) << separate_time / fused_time << " | "
+         << "min " << fused.min << " @" << fused.argmin << ", max " << fused.max << " @" << fused.argmax
+         << ", mean " << fused.mean() << ", var " << fused.variance()
+         << (correct ? " | OK" : " | MISMATCH") << endl;
+    return correct;
 }
 
-int main() {
-    cout << "Vector Size   | Threads   | Execution Time  | Min and Max Values\n";
-    cout << "-------------------------------------------------------------------\n";
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    options.min_repeats = 10;
+    BenchmarkRunner runner("openmp1", parse_benchmark_options(argc, argv, options));
+
+    // --mode=simd добавляет к сравнению векторизованные варианты,
+    // --mode=fused сравнивает однопроходные статистики с отдельными ядрами
+    string mode = get_option(argc, argv, "mode", "default");
+    string isa_name;
+    MinMaxKernel kernel = select_min_max_kernel(get_option(argc, argv, "isa", "auto"), isa_name);
+    if (mode == "simd") {
+        cout << "SIMD kernel: " << isa_name << "\n";
+    }
 
+    uint64_t seed = parse_data_seed(argc, argv);
     vector<int> vector_sizes = {10000, 100000, 1000000, 10000000};
     vector<int> thread_counts = {1, 2, 4, 8, 16};
-    int num_repeats = 10;
+
+    // Калибровка порога: ядро на одном потоке по вектору вне кэша L1
+    vector<int> sample(1 << 18);
+    fill_uniform_ints(sample, 1, 10000, seed);
+    min_max_policy = make_execution_policy(argc, argv, "min_max_reduction",
+        *max_element(thread_counts.begin(), thread_counts.end()), sample.size(), [&]() {
+        int min_val, max_val;
+        min_max_reduction(sample, 1, min_val, max_val);
+        do_not_optimize(min_val);
+        do_not_optimize(max_val);
+    });
+    print_execution_policy(min_max_policy);
+
+    if (mode == "fused") {
+        statistics_policy = make_execution_policy(argc, argv, "statistics_fused",
+            *max_element(thread_counts.begin(), thread_counts.end()), sample.size(), [&]() {
+            do_not_optimize(compute_statistics(sample.data(), sample.size(), 1).sum);
+        });
+        print_execution_policy(statistics_policy);
+
+        cout << "Size       | Threads | Effective | Fused (s)     | Separate (s)  | Speedup | Statistics\n";
+        cout << "-------------------------------------------------------------------------------------------------\n";
+        bool correct = true;
+        for (int size : vector_sizes) {
+            vector<int> vec(size);
+            fill_uniform_ints(vec, 1, 10000, seed);
+            for (int threads : thread_counts) {
+                correct = compare_fused_statistics(vec, threads, runner) && correct;
+            }
+        }
+        return correct ? 0 : 1;
+    }
+
+    cout << "Vector Size   | Threads   | Effective | Median Time     | Min and Max Values                | Bandwidth\n";
+    cout << "-------------------------------------------------------------------------------------------------\n";
 
     // Основной цикл по размерам векторов
     for (int size : vector_sizes) {
-        // Генерация случайного вектора
+        // Генерация случайного вектора (параллельно, воспроизводимо по --seed)
         vector<int> vec(size);
-        for (int i = 0; i < size; ++i) {
-            vec[i] = rand() % 10000 + 1;
-        }
+        fill_uniform_ints(vec, 1, 10000, seed);
 
         // Цикл по количеству потоков
         for (int threads : thread_counts) {
-            find_min_max_reduction(vec, threads, num_repeats);
-            find_min_max_no_reduction(vec, threads, num_repeats);
+            find_min_max_reduction(vec, threads, runner);
+            find_min_max_no_reduction(vec, threads, runner);
+            if (mode == "simd") {
+                find_min_max_simd(vec, threads, runner);
+                find_min_max_vectorized(vec, threads, kernel, isa_name, runner);
+            }
         }
     }
 
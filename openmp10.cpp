@@ -0,0 +1,368 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <omp.h>
+#include <iomanip>
+#include <limits>
+#include <algorithm>
+#include "benchmark.h"
+#include "data_generator.h"
+
+using namespace std;
+
+// Накладные расходы конструкций OpenMP в духе EPCC syncbench/schedbench:
+// конструкция выполняется inner_reps раз вокруг короткой задержки delay(),
+// из времени вычитается время тех же задержек без конструкции, и разность,
+// делённая на inner_reps, - стоимость одной конструкции. По ней оценивается
+// минимальный размер задачи, при котором ядра программ openmp1-openmp7 имеет
+// смысл распараллеливать.
+
+// Задержка ~ delay_length итераций, которую компилятор не может выбросить
+void delay(int delay_length) {
+    double a = 0.0;
+    for (int i = 0; i < delay_length; ++i) {
+        a += i;
+    }
+    do_not_optimize(a);
+}
+
+// Подбор delay_length так, чтобы delay() длилась около target_us микросекунд
+int calibrate_delay(double target_us) {
+    int delay_length = 1;
+    while (true) {
+        const int reps = 1000;
+        double start = omp_get_wtime();
+        for (int r = 0; r < reps; ++r) {
+            delay(delay_length);
+        }
+        double per_call_us = (omp_get_wtime() - start) / reps * 1e6;
+        if (per_call_us >= target_us || delay_length > (1 << 26)) return delay_length;
+        delay_length *= 2;
+    }
+}
+
+struct OverheadTest {
+    const char* name;
+    // Выполнение inner_reps конструкций на num_threads потоках
+    void (*run)(int num_threads, int inner_reps, int delay_length);
+};
+
+// Эталон: те же задержки последовательно, без конструкций OpenMP
+void reference(int, int inner_reps, int delay_length) {
+    for (int j = 0; j < inner_reps; ++j) {
+        delay(delay_length);
+    }
+}
+
+void test_parallel(int num_threads, int inner_reps, int delay_length) {
+    for (int j = 0; j < inner_reps; ++j) {
+        #pragma omp parallel num_threads(num_threads)
+        {
+            delay(delay_length);
+        }
+    }
+}
+
+void test_barrier(int num_threads, int inner_reps, int delay_length) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps; ++j) {
+            delay(delay_length);
+            #pragma omp barrier
+        }
+    }
+}
+
+void test_for(int num_threads, int inner_reps, int delay_length) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps; ++j) {
+            #pragma omp for
+            for (int i = 0; i < num_threads; ++i) {
+                delay(delay_length);
+            }
+        }
+    }
+}
+
+void test_parallel_for(int num_threads, int inner_reps, int delay_length) {
+    for (int j = 0; j < inner_reps; ++j) {
+        #pragma omp parallel for num_threads(num_threads)
+        for (int i = 0; i < num_threads; ++i) {
+            delay(delay_length);
+        }
+    }
+}
+
+void test_reduction(int num_threads, int inner_reps, int delay_length) {
+    int sum = 0;
+    for (int j = 0; j < inner_reps; ++j) {
+        #pragma omp parallel num_threads(num_threads) reduction(+:sum)
+        {
+            delay(delay_length);
+            sum += 1;
+        }
+    }
+    do_not_optimize(sum);
+}
+
+// Для critical, замка и atomic все inner_reps операций выполняются по очереди,
+// поэтому каждый поток делает inner_reps / num_threads из них
+void test_critical(int num_threads, int inner_reps, int delay_length) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps / num_threads; ++j) {
+            #pragma omp critical
+            {
+                delay(delay_length);
+            }
+        }
+    }
+}
+
+void test_lock(int num_threads, int inner_reps, int delay_length) {
+    omp_lock_t lock;
+    omp_init_lock(&lock);
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps / num_threads; ++j) {
+            omp_set_lock(&lock);
+            delay(delay_length);
+            omp_unset_lock(&lock);
+        }
+    }
+    omp_destroy_lock(&lock);
+}
+
+void test_atomic(int num_threads, int inner_reps, int delay_length) {
+    double sum = 0.0;
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps / num_threads; ++j) {
+            delay(delay_length);
+            #pragma omp atomic
+            sum += 1.0;
+        }
+    }
+    do_not_optimize(sum);
+}
+
+// Распределение итераций (schedbench): по iterations_per_thread итераций на
+// поток, каждая - delay(); параллельная область одна на все повторения
+const int iterations_per_thread = 128;
+
+void test_schedule_static(int num_threads, int inner_reps, int delay_length) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps / iterations_per_thread; ++j) {
+            #pragma omp for schedule(static)
+            for (int i = 0; i < num_threads * iterations_per_thread; ++i) {
+                delay(delay_length);
+            }
+        }
+    }
+}
+
+void test_schedule_dynamic(int num_threads, int inner_reps, int delay_length) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps / iterations_per_thread; ++j) {
+            #pragma omp for schedule(dynamic, 1)
+            for (int i = 0; i < num_threads * iterations_per_thread; ++i) {
+                delay(delay_length);
+            }
+        }
+    }
+}
+
+void test_schedule_guided(int num_threads, int inner_reps, int delay_length) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        for (int j = 0; j < inner_reps / iterations_per_thread; ++j) {
+            #pragma omp for schedule(guided, 1)
+            for (int i = 0; i < num_threads * iterations_per_thread; ++i) {
+                delay(delay_length);
+            }
+        }
+    }
+}
+
+// Число конструкций, выполненных тестом (для перевода времени в стоимость одной)
+int construct_count(const string& name, int num_threads, int inner_reps) {
+    if (name == "critical" || name == "lock" || name == "atomic") {
+        return inner_reps / num_threads * num_threads;
+    }
+    if (name.compare(0, 8, "schedule") == 0) {
+        return inner_reps / iterations_per_thread * num_threads * iterations_per_thread;
+    }
+    return inner_reps;
+}
+
+// Число задержек, выполненных каждым потоком: оно и составляет эталонное время
+int delays_per_thread(const string& name, int num_threads, int inner_reps) {
+    if (name == "critical" || name == "lock") {
+        return inner_reps / num_threads * num_threads;  // выполняются по очереди
+    }
+    if (name == "atomic") {
+        return inner_reps / num_threads;
+    }
+    if (name.compare(0, 8, "schedule") == 0) {
+        return inner_reps / iterations_per_thread * iterations_per_thread;
+    }
+    return inner_reps;
+}
+
+// Последовательная стоимость одного элемента ядер программ (нс), измеренная
+// на массиве, который заведомо больше кэша L1
+struct KernelCost {
+    string name;
+    double ns_per_element;
+};
+
+vector<KernelCost> measure_kernel_costs(BenchmarkRunner& runner, uint64_t seed) {
+    const int n = 1 << 20;
+    vector<int> ints(n);
+    fill_uniform_ints(ints, 1, 10000, seed);
+    vector<double> A(n, 1.5), B(n, 2.5);
+    vector<KernelCost> costs;
+    BenchmarkParams params = {{"size", to_string(n)}};
+
+    double time = runner.run("serial_min_max", params, [&]() {
+        int min_val = numeric_limits<int>::max();
+        int max_val = numeric_limits<int>::lowest();
+        for (int i = 0; i < n; ++i) {
+            min_val = min(min_val, ints[i]);
+            max_val = max(max_val, ints[i]);
+        }
+        do_not_optimize(min_val);
+        do_not_optimize(max_val);
+    }).median;
+    costs.push_back({"openmp1 min/max", time / n * 1e9});
+
+    time = runner.run("serial_dot_product", params, [&]() {
+        double dot_product = 0.0;
+        for (int i = 0; i < n; ++i) {
+            dot_product += A[i] * B[i];
+        }
+        do_not_optimize(dot_product);
+    }).median;
+    costs.push_back({"openmp2 dot product", time / n * 1e9});
+
+    time = runner.run("serial_integral", params, [&]() {
+        double h = 1.0 / n;
+        double sum = 0.0;
+        for (int i = 0; i < n; ++i) {
+            double x = (i + 0.5) * h;
+            sum += x * x * x;
+        }
+        do_not_optimize(sum);
+    }).median;
+    costs.push_back({"openmp3 integral", time / n * 1e9});
+
+    time = runner.run("serial_sum", params, [&]() {
+        long long sum = 0;
+        for (int i = 0; i < n; ++i) {
+            sum += ints[i];
+        }
+        do_not_optimize(sum);
+    }).median;
+    costs.push_back({"openmp7 sum", time / n * 1e9});
+
+    return costs;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    options.min_repeats = 10;
+    BenchmarkRunner runner("openmp10", parse_benchmark_options(argc, argv, options));
+
+    // Число потоков - целое >= 1: на него делятся повторения critical/lock/atomic
+    vector<int> thread_counts;
+    if (!parse_positive_list(get_option(argc, argv, "threads", "1,2,4,8,16"), thread_counts)) {
+        cerr << "Invalid thread counts (expected integers >= 1): " << get_option(argc, argv, "threads", "") << endl;
+        return 1;
+    }
+    // --delay-us: длительность задержки внутри конструкции, --inner-reps: конструкций на замер
+    const double delay_us = stod(get_option(argc, argv, "delay-us", "0.1"));
+    // Каждый тест должен выполнить хотя бы одну конструкцию: распределение итераций
+    // делит inner_reps на iterations_per_thread, critical/lock/atomic - на число потоков
+    size_t parsed_reps = 0;
+    const int min_inner_reps = max(iterations_per_thread, *max_element(thread_counts.begin(), thread_counts.end()));
+    if (!parse_positive(get_option(argc, argv, "inner-reps", "1024"), parsed_reps) ||
+        parsed_reps < static_cast<size_t>(min_inner_reps) ||
+        parsed_reps > static_cast<size_t>(numeric_limits<int>::max())) {
+        cerr << "Invalid inner repetitions (expected an integer >= " << min_inner_reps
+             << "): " << get_option(argc, argv, "inner-reps", "") << endl;
+        return 1;
+    }
+    const int inner_reps = static_cast<int>(parsed_reps);
+    const int delay_length = calibrate_delay(delay_us);
+
+    const vector<OverheadTest> tests = {
+        {"parallel", test_parallel},
+        {"barrier", test_barrier},
+        {"for", test_for},
+        {"parallel for", test_parallel_for},
+        {"reduction", test_reduction},
+        {"critical", test_critical},
+        {"lock", test_lock},
+        {"atomic", test_atomic},
+        {"schedule static", test_schedule_static},
+        {"schedule dynamic,1", test_schedule_dynamic},
+        {"schedule guided,1", test_schedule_guided},
+    };
+
+    cout << "Delay length: " << delay_length << " iterations (~" << delay_us << " us), inner repetitions: " << inner_reps << "\n";
+    cout << "Construct           | Threads | Overhead (us)\n";
+    cout << "---------------------------------------------\n";
+
+    // Стоимость входа в параллельную область с редукцией - для оценки порога
+    vector<double> region_overhead_us(thread_counts.size(), 0.0);
+
+    double reference_time = runner.run("reference", {{"inner_reps", to_string(inner_reps)}}, [&]() {
+        reference(1, inner_reps, delay_length);
+    }).median;
+    double delay_time = reference_time / inner_reps;
+
+    for (size_t t = 0; t < thread_counts.size(); ++t) {
+        int num_threads = thread_counts[t];
+        for (const OverheadTest& test : tests) {
+            double time = runner.run("overhead", {{"construct", test.name}, {"threads", to_string(num_threads)}}, [&]() {
+                test.run(num_threads, inner_reps, delay_length);
+            }).median;
+
+            string name = test.name;
+            double overhead = (time - delays_per_thread(name, num_threads, inner_reps) * delay_time) /
+                              construct_count(name, num_threads, inner_reps);
+            if (name == "reduction") region_overhead_us[t] = max(0.0, overhead * 1e6);
+
+            cout << setw(19) << left << name << right << " | " << setw(7) << num_threads << " | "
+                 << fixed << setprecision(3) << setw(13) << overhead * 1e6 << "\n";
+        }
+        cout << "---------------------------------------------\n";
+    }
+
+    // Порог распараллеливания: параллельная версия быстрее последовательной,
+    // если n * c / p + O < n * c, то есть n > O / (c * (1 - 1 / p)),
+    // где c - стоимость элемента, O - стоимость параллельной области с редукцией
+    vector<KernelCost> costs = measure_kernel_costs(runner, parse_data_seed(argc, argv));
+
+    cout << "\nKernel              | ns/element | Threads | Region + reduction (us) | Break-even size\n";
+    cout << "--------------------------------------------------------------------------------------\n";
+    for (const KernelCost& cost : costs) {
+        for (size_t t = 0; t < thread_counts.size(); ++t) {
+            int num_threads = thread_counts[t];
+            cout << setw(19) << left << cost.name << right << " | " << fixed << setprecision(3) << setw(10)
+                 << cost.ns_per_element << " | " << setw(7) << num_threads << " | " << setw(23)
+                 << region_overhead_us[t] << " | ";
+            if (num_threads == 1) {
+                cout << setw(15) << "-" << "\n";
+            } else {
+                double break_even = region_overhead_us[t] * 1e3 / (cost.ns_per_element * (1.0 - 1.0 / num_threads));
+                cout << setw(15) << static_cast<long long>(break_even) << "\n";
+            }
+        }
+    }
+
+    return 0;
+}
@@ -2,58 +2,176 @@
 #include <vector>
 #include <omp.h>
 #include <iomanip>
-#include <chrono>
+#include <cmath>
+#include <algorithm>
+#include "benchmark.h"
+#include "numa_array.h"
+#include "execution_policy.h"
 
 using namespace std;
 
-// Функция для вычисления скалярного произведения двух векторов
-void compute_dot_product(int vector_size, int num_threads, int num_repeats) {
-    vector<double> A(vector_size, 1.0);
-    vector<double> B(vector_size, 2.0);
-    double dot_product = 0.0;
+// Размер блока воспроизводимого суммирования. Он не зависит от числа потоков,
+// поэтому разбиение на блоки и порядок сложения одинаковы при любом запуске
+const int reproducible_block_size = 4096;
 
-    // Установка количества потоков
-    omp_set_num_threads(num_threads);
+// Политика выполнения скалярного произведения, калибруется в main
+ExecutionPolicy dot_product_policy;
 
-    double total_time = 0.0;
+// Обычная параллельная редукция: результат зависит от числа потоков
+double dot_product_plain(const double* A, const double* B, int n, int threads) {
+    double dot_product = 0.0;
 
-    for (int r = 0; r < num_repeats; ++r) {
-        dot_product = 0.0;
+    // Распределение schedule(static) совпадает с распределением при инициализации
+    #pragma omp parallel for num_threads(threads) if(threads > 1) schedule(static) reduction(+:dot_product)
+    for (int i = 0; i < n; ++i) {
+        dot_product += A[i] * B[i];
+    }
+    return dot_product;
+}
+
+// Попарное (древовидное) сложение частичных сумм; форма дерева зависит только от count
+double pairwise_sum(const double* values, size_t count) {
+    if (count == 0) return 0.0;
+    if (count == 1) return values[0];
+    size_t half = count / 2;
+    return pairwise_sum(values, half) + pairwise_sum(values + half, count - half);
+}
 
-        // Начало измерения времени
-        auto start = chrono::high_resolution_clock::now();
+// Воспроизводимое скалярное произведение: блоки фиксированного размера
+// суммируются с компенсацией (Neumaier, вариант Кэхэна), затем суммы блоков
+// складываются детерминированным деревом. Результат побитово одинаков при
+// любом числе потоков (при сборке без -ffast-math, который ломает компенсацию).
+double dot_product_reproducible(const double* A, const double* B, int n, vector<double>& block_sums) {
+    int num_blocks = (n + reproducible_block_size - 1) / reproducible_block_size;
+    block_sums.resize(num_blocks);
 
-        #pragma omp parallel for reduction(+:dot_product)
-        for (int i = 0; i < vector_size; ++i) {
-            dot_product += A[i] * B[i];
+    #pragma omp parallel for schedule(static)
+    for (int block = 0; block < num_blocks; ++block) {
+        int begin = block * reproducible_block_size;
+        int end = min(begin + reproducible_block_size, n);
+        double sum = 0.0;
+        double compensation = 0.0;
+        for (int i = begin; i < end; ++i) {
+            double term = A[i] * B[i];
+            double t = sum + term;
+            if (fabs(sum) >= fabs(term)) {
+                compensation += (sum - t) + term;
+            } else {
+                compensation += (term - t) + sum;
+            }
+            sum = t;
         }
-
-        // Конец измерения времени
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> duration = end - start;
-        total_time += duration.count();
+        block_sums[block] = sum + compensation;
     }
 
-    double average_time = total_time / num_repeats;
+    return pairwise_sum(block_sums.data(), block_sums.size());
+}
+
+// Функция для вычисления скалярного произведения двух векторов
+void compute_dot_product(int vector_size, int num_threads, bool parallel_init, BenchmarkRunner& runner) {
+    // Число потоков по размеру векторов (num_threads - верхняя граница).
+    // Задаётся до выделения памяти, чтобы первое касание страниц выполнялось
+    // той же командой потоков, что и вычисление
+    int threads = dot_product_policy.threads_for(vector_size, num_threads);
+    omp_set_num_threads(threads);
+
+    NumaArray<double> A(vector_size, 1.0, parallel_init);
+    NumaArray<double> B(vector_size, 2.0, parallel_init);
+    double dot_product = 0.0;
+
+    BenchmarkStats stats = runner.run("dot_product",
+        {{"size", to_string(vector_size)}, {"threads", to_string(num_threads)},
+         {"effective_threads", to_string(threads)}, {"init", parallel_init ? "parallel" : "serial"}}, [&]() {
+        dot_product = dot_product_plain(A.data(), B.data(), vector_size, threads);
+    });
 
     cout << setw(15) << vector_size << " | "
          << setw(10) << num_threads << " | "
-         << setw(15) << average_time << " s | "
+         << setw(9) << threads << " | "
+         << setw(15) << stats.median << " s | "
          << setw(20) << dot_product << endl;
 }
 
-int main() {
-    cout << "Vector Size    | Threads   | Execution Time  | Dot Product\n";
-    cout << "------------------------------------------------------------------\n";
+// Сравнение обычной и воспроизводимой редукции на данных, где порядок
+// сложения влияет на результат (A[i] = 1 / (i + 1), B[i] = 1)
+void compare_reproducible_dot_product(int vector_size, int num_threads, bool parallel_init, BenchmarkRunner& runner) {
+    omp_set_num_threads(num_threads);
+
+    NumaArray<double> A(vector_size, 0.0, parallel_init);
+    NumaArray<double> B(vector_size, 1.0, parallel_init);
+    #pragma omp parallel for schedule(static)
+    for (int i = 0; i < vector_size; ++i) {
+        A[i] = 1.0 / (i + 1.0);
+    }
+
+    double plain = 0.0;
+    double reproducible = 0.0;
+    vector<double> block_sums;
+    BenchmarkParams params = {{"size", to_string(vector_size)}, {"threads", to_string(num_threads)},
+                              {"effective_threads", to_string(num_threads)}};
+
+    BenchmarkStats plain_stats = runner.run("dot_product_plain", params, [&]() {
+        plain = dot_product_plain(A.data(), B.data(), vector_size, num_threads);
+    });
+    BenchmarkStats reproducible_stats = runner.run("dot_product_reproducible", params, [&]() {
+        reproducible = dot_product_reproducible(A.data(), B.data(), vector_size, block_sums);
+    });
+
+    cout << setw(15) << vector_size << " | "
+         << setw(10) << num_threads << " | "
+         << setw(9) << num_threads << " | "
+         << setw(15) << plain_stats.median << " s | "
+         << setprecision(17) << setw(24) << plain << setprecision(6) << " (plain)" << endl;
+    cout << setw(15) << vector_size << " | "
+         << setw(10) << num_threads << " | "
+         << setw(9) << num_threads << " | "
+         << setw(15) << reproducible_stats.median << " s | "
+         << setprecision(17) << setw(24) << reproducible << setprecision(3)
+         << " (reproducible, x" << reproducible_stats.median / plain_stats.median << " time)"
+         << setprecision(6) << endl;
+}
+
+int main(int argc, char* argv[]) {
+    apply_thread_binding(argc, argv);
+
+    BenchmarkOptions options;
+    options.min_repeats = 10;
+    BenchmarkRunner runner("openmp2", parse_benchmark_options(argc, argv, options));
+
+    // --init=serial воспроизводит прежнее поведение (все страницы на узле главного потока)
+    bool parallel_init = get_option(argc, argv, "init", "parallel") != "serial";
+    bool show_placement = get_option(argc, argv, "show-placement", "0") == "1";
+    // --mode=reproducible сравнивает обычную редукцию с воспроизводимой
+    bool reproducible_mode = get_option(argc, argv, "mode", "default") == "reproducible";
 
     vector<int> vector_sizes = {10000, 100000, 1000000, 100000000};
     vector<int> thread_counts = {1, 2, 4, 8, 12, 16};
-    int num_repeats = 10;
+
+    // Калибровка порога: ядро на одном потоке по векторам вне кэша L2
+    vector<double> sample_A(1 << 18, 1.0), sample_B(1 << 18, 2.0);
+    dot_product_policy = make_execution_policy(argc, argv, "dot_product",
+        *max_element(thread_counts.begin(), thread_counts.end()), sample_A.size(), [&]() {
+        do_not_optimize(dot_product_plain(sample_A.data(), sample_B.data(), sample_A.size(), 1));
+    });
+    print_execution_policy(dot_product_policy);
+
+    if (show_placement) {
+        for (int threads : thread_counts) {
+            print_thread_placement(threads);
+        }
+    }
+
+    cout << "Vector Size    | Threads   | Effective | Median Time     | Dot Product\n";
+    cout << "------------------------------------------------------------------------------\n";
 
     // Запускаем тесты для всех размеров векторов и всех вариантов числа потоков
     for (int size : vector_sizes) {
         for (int threads : thread_counts) {
-            compute_dot_product(size, threads, num_repeats);
+            if (reproducible_mode) {
+                compare_reproducible_dot_product(size, threads, parallel_init, runner);
+            } else {
+                compute_dot_product(size, threads, parallel_init, runner);
+            }
         }
     }
 
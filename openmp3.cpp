@@ -2,7 +2,12 @@
 #include <vector>
 #include <omp.h>
 #include <iomanip>
-#include <chrono>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+#include "benchmark.h"
+#include "numa_array.h"
+#include "execution_policy.h"
 
 using namespace std;
 
@@ -11,59 +16,258 @@ double function(double x) {
     return x * x * x;
 }
 
-// Функция для вычисления интеграла методом средних прямоугольников
-double compute_integral(double a, double b, int n, int num_threads, int num_repeats, double& avg_time) {
-    double h = (b - a) / n;  // Шаг разбиения
+// Подынтегральные функции передаются как функторы, чтобы вызов встраивался
+struct CubicIntegrand {
+    static const char* name() { return "cubic"; }
+    double operator()(double x) const { return function(x); }
+    double exact(double a, double b) const { return (b * b * b * b - a * a * a * a) / 4; }
+};
 
-    // Установка количества потоков
-    omp_set_num_threads(num_threads);
-    double total_time = 0.0;
+// Узкий пик в точке center: почти вся погрешность сосредоточена рядом с ним
+struct PeakIntegrand {
+    static const char* name() { return "peak"; }
+    double center = 0.3;
+    double width = 1e-4;
+    double operator()(double x) const { return 1.0 / (width + (x - center) * (x - center)); }
+    double exact(double a, double b) const {
+        double s = sqrt(width);
+        return (atan((b - center) / s) - atan((a - center) / s)) / s;
+    }
+};
+
+// Политика выполнения метода прямоугольников отдельно для каждой
+// подынтегральной функции (стоимость вычисления у них разная), калибруется в main
+template <typename Integrand>
+ExecutionPolicy integral_policy;
+
+// Сумма значений функции в центрах n отрезков шага h на threads потоках
+template <typename Integrand>
+double midpoint_sum(const Integrand& f, double a, double h, int n, int threads) {
     double integral = 0.0;
-    for (int r = 0; r < num_repeats; ++r) {
-        integral = 0.0;
-        
-        // Начало измерения времени
-        auto start = chrono::high_resolution_clock::now();
-
-        #pragma omp parallel for reduction(+:integral)
-        for (int i = 0; i < n; ++i) {
-            double x = a + (i + 0.5) * h;  // Центр i-го отрезка
-            integral += function(x);  // Суммируем значения функции в точках
-        }
 
-        // Конец измерения времени
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> duration = end - start;
-        total_time += duration.count();
+    #pragma omp parallel for num_threads(threads) if(threads > 1) schedule(static) reduction(+:integral)
+    for (int i = 0; i < n; ++i) {
+        double x = a + (i + 0.5) * h;  // Центр i-го отрезка
+        integral += f(x);  // Суммируем значения функции в точках
     }
+    return integral;
+}
+
+template <typename Integrand>
+void calibrate_integral_policy(int argc, char* argv[], const Integrand& f, int max_threads) {
+    const int sample_size = 1 << 16;
+    integral_policy<Integrand> = make_execution_policy(argc, argv, string("integral ") + f.name(), max_threads,
+        sample_size, [&]() {
+        do_not_optimize(midpoint_sum(f, 0.0, 1.0 / sample_size, sample_size, 1));
+    });
+    print_execution_policy(integral_policy<Integrand>);
+}
+
+// Функция для вычисления интеграла методом средних прямоугольников.
+// effective_threads - число потоков, выбранное политикой выполнения
+template <typename Integrand>
+double compute_integral(const Integrand& f, double a, double b, int n, int num_threads, BenchmarkRunner& runner,
+                        double& avg_time, int& effective_threads) {
+    double h = (b - a) / n;  // Шаг разбиения
+
+    // Число потоков по числу разбиений, num_threads - верхняя граница
+    int threads = integral_policy<Integrand>.threads_for(n, num_threads);
+    double integral = 0.0;
+    BenchmarkStats stats = runner.run("integral",
+        {{"integrand", f.name()}, {"divisions", to_string(n)}, {"threads", to_string(num_threads)},
+         {"effective_threads", to_string(threads)}}, [&]() {
+        integral = midpoint_sum(f, a, h, n, threads);
+    });
 
-    avg_time = total_time / num_repeats;
+    avg_time = stats.median;
+    effective_threads = threads;
 
     // Умножаем на шаг h, чтобы получить окончательное значение интеграла
     integral *= (b - a) / n;
     return integral;
 }
 
-int main() {
-    cout << "Number of Divisions | Threads | Execution Time | Integral Value\n";
-    cout << "---------------------------------------------------------------\n";
+// Квадратурные правила. richardson = 2^p - 1, где p - порядок правила:
+// разность оценок на отрезке и на двух его половинах, делённая на richardson,
+// оценивает погрешность уточнённого значения.
+struct SimpsonRule {
+    static constexpr int points = 3;
+    static constexpr double richardson = 15.0;
+
+    template <typename Integrand>
+    double operator()(const Integrand& f, double a, double b) const {
+        double m = 0.5 * (a + b);
+        return (b - a) / 6.0 * (f(a) + 4.0 * f(m) + f(b));
+    }
+};
+
+// Пятиточечное правило Гаусса-Лежандра (точно для многочленов степени до 9)
+struct GaussLegendre5Rule {
+    static constexpr int points = 5;
+    static constexpr double richardson = 1023.0;
+
+    template <typename Integrand>
+    double operator()(const Integrand& f, double a, double b) const {
+        static const double nodes[5] = {0.0, -0.5384693101056831, 0.5384693101056831, -0.9061798459386640, 0.9061798459386640};
+        static const double weights[5] = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665, 0.2369268850561891, 0.2369268850561891};
+        double half = 0.5 * (b - a);
+        double mid = 0.5 * (a + b);
+        double sum = 0.0;
+        for (int k = 0; k < 5; ++k) {
+            sum += weights[k] * f(mid + half * nodes[k]);
+        }
+        return half * sum;
+    }
+};
+
+// Глубина, до которой подотрезки порождают задачи OpenMP; глубже работа
+// слишком мелкая, и рекурсия продолжается в текущей задаче
+const int adaptive_task_depth = 12;
+const int adaptive_max_depth = 50;
+
+// Рекурсивное адаптивное интегрирование: отрезок делится пополам, пока
+// оценка погрешности больше допуска. Половины уточняются параллельно.
+// evaluations - число вычислений f в этом поддереве: каждая задача считает
+// свои в локальную переменную, и суммы складываются после taskwait, без
+// общего атомарного счётчика
+template <typename Rule, typename Integrand>
+double adaptive_step(const Integrand& f, double a, double b, double whole, double tolerance, int depth, long long& evaluations) {
+    Rule rule;
+    double m = 0.5 * (a + b);
+    double left = rule(f, a, m);
+    double right = rule(f, m, b);
+    evaluations = 2 * Rule::points;
+
+    double refined = left + right;
+    double error = (refined - whole) / Rule::richardson;
+    if (fabs(error) <= tolerance || depth >= adaptive_max_depth) {
+        return refined + error;
+    }
+
+    double left_result = 0.0, right_result = 0.0;
+    long long left_evaluations = 0, right_evaluations = 0;
+    #pragma omp task shared(f, left_result, left_evaluations) if(depth < adaptive_task_depth)
+    left_result = adaptive_step<Rule>(f, a, m, left, 0.5 * tolerance, depth + 1, left_evaluations);
+    #pragma omp task shared(f, right_result, right_evaluations) if(depth < adaptive_task_depth)
+    right_result = adaptive_step<Rule>(f, m, b, right, 0.5 * tolerance, depth + 1, right_evaluations);
+    #pragma omp taskwait
+    evaluations += left_evaluations + right_evaluations;
+    return left_result + right_result;
+}
+
+// Адаптивный интеграл с заданной абсолютной погрешностью
+template <typename Rule, typename Integrand>
+double integrate_adaptive(const Integrand& f, double a, double b, double tolerance, long long& evaluations) {
+    double result = 0.0;
+    long long step_evaluations = 0;
+
+    #pragma omp parallel
+    #pragma omp single
+    result = adaptive_step<Rule>(f, a, b, Rule()(f, a, b), tolerance, 0, step_evaluations);
+
+    evaluations = Rule::points + step_evaluations;
+    return result;
+}
+
+// Допуск в формате %g ("1e-10"): to_string дал бы "0.000000"
+// для всех малых допусков, и строки CSV/JSON с разными допусками совпали бы
+string format_tolerance(double tolerance) {
+    ostringstream text;
+    text << tolerance;
+    return text.str();
+}
+
+// Сравнение адаптивных правил с методом средних прямоугольников по числу
+// вычислений функции и фактической погрешности
+template <typename Rule, typename Integrand>
+void run_adaptive(const string& rule_name, const Integrand& f, double a, double b,
+                  double tolerance, int num_threads, BenchmarkRunner& runner) {
+    omp_set_num_threads(num_threads);
+    double integral = 0.0;
+    long long evaluations = 0;
+    BenchmarkStats stats = runner.run("integral_adaptive",
+        {{"integrand", f.name()}, {"rule", rule_name}, {"tolerance", format_tolerance(tolerance)},
+         {"threads", to_string(num_threads)}, {"effective_threads", to_string(num_threads)}}, [&]() {
+        integral = integrate_adaptive<Rule>(f, a, b, tolerance, evaluations);
+    });
+
+    cout << setw(10) << f.name() << " | "
+         << setw(16) << rule_name << " | "
+         << setw(7) << num_threads << " | "
+         << setw(9) << num_threads << " | "
+         << setw(12) << stats.median << " s | "
+         << setw(11) << evaluations << " | "
+         << setw(12) << fabs(integral - f.exact(a, b)) << endl;
+}
+
+template <typename Integrand>
+void compare_quadrature(const Integrand& f, double a, double b, double tolerance,
+                        const vector<int>& divisions, const vector<int>& thread_counts, BenchmarkRunner& runner) {
+    for (int threads : thread_counts) {
+        for (int n : divisions) {
+            double avg_time;
+            int effective_threads;
+            double integral = compute_integral(f, a, b, n, threads, runner, avg_time, effective_threads);
+            cout << setw(10) << f.name() << " | "
+                 << setw(16) << "midpoint" << " | "
+                 << setw(7) << threads << " | "
+                 << setw(9) << effective_threads << " | "
+                 << setw(12) << avg_time << " s | "
+                 << setw(11) << n << " | "
+                 << setw(12) << fabs(integral - f.exact(a, b)) << endl;
+        }
+        run_adaptive<SimpsonRule>("adaptive simpson", f, a, b, tolerance, threads, runner);
+        run_adaptive<GaussLegendre5Rule>("adaptive gauss5", f, a, b, tolerance, threads, runner);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    apply_thread_binding(argc, argv);
+
+    BenchmarkOptions options;
+    options.min_repeats = 10;
+    BenchmarkRunner runner("openmp3", parse_benchmark_options(argc, argv, options));
 
     double a = 0.0, b = 1.0;  // Границы интегрирования
     vector<int> divisions = {10000, 100000, 1000000};
     vector<int> thread_counts = {1, 2, 4, 8, 16};
-    int num_repeats = 10;
+
+    if (get_option(argc, argv, "show-placement", "0") == "1") {
+        for (int threads : thread_counts) {
+            print_thread_placement(threads);
+        }
+    }
+
+    int max_threads = *max_element(thread_counts.begin(), thread_counts.end());
+    calibrate_integral_policy(argc, argv, CubicIntegrand(), max_threads);
+    calibrate_integral_policy(argc, argv, PeakIntegrand(), max_threads);
+
+    // --mode=adaptive: адаптивные правила против перебора с --tolerance=
+    if (get_option(argc, argv, "mode", "default") == "adaptive") {
+        double tolerance = atof(get_option(argc, argv, "tolerance", "1e-10").c_str());
+        cout << "Integrand  | Method           | Threads | Effective | Median Time    | Evaluations | Abs Error\n";
+        cout << "-----------------------------------------------------------------------------------------------\n";
+        compare_quadrature(CubicIntegrand(), a, b, tolerance, divisions, thread_counts, runner);
+        compare_quadrature(PeakIntegrand(), a, b, tolerance, divisions, thread_counts, runner);
+        return 0;
+    }
+
+    cout << "Number of Divisions | Threads | Effective | Median Time    | Integral Value\n";
+    cout << "---------------------------------------------------------------------------\n";
 
     // Внешний цикл по количеству разбиений
     for (int n : divisions) {
         for (int threads : thread_counts) {
             double avg_time;
-            double integral = compute_integral(a, b, n, threads, num_repeats, avg_time);
+            int effective_threads;
+            double integral = compute_integral(CubicIntegrand(), a, b, n, threads, runner, avg_time, effective_threads);
             cout << setw(18) << n << " | "
                  << setw(10) << threads << " | "
+                 << setw(9) << effective_threads << " | "
                  << setw(15) << avg_time << " s | "
                  << setw(15) << integral << endl;
         }
     }
 
     return 0;
-}
+}
\ No newline at end of file
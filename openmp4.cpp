@@ -3,70 +3,112 @@
 #include <omp.h>
 #include <iomanip>
 #include <algorithm>
-#include <chrono>
+#include "benchmark.h"
+#include "matrix.h"
+#include "data_generator.h"
+#include "execution_policy.h"
+#include "statistics.h"
 
 using namespace std;
 
-// Функция для поиска минимального элемента в строке матрицы
-double find_min_in_row(const vector<double>& row) {
-    return *min_element(row.begin(), row.end());
-}
+// Политика выполнения поиска, калибруется в main
+ExecutionPolicy max_of_mins_policy;
 
-// Функция для нахождения максимального значения среди минимальных элементов строк матрицы
-double find_max_of_mins(const vector<vector<double>>& matrix, int num_threads, int num_repeats, double& avg_time) {
+// Максимум минимумов строк параллельным циклом по строкам на threads потоках.
+// min_element сразу даёт первый столбец минимума строки, так что позиция
+// победителя достаётся без повторного просмотра
+template <typename MatrixType>
+LocatedValue<double> max_of_row_mins(const MatrixType& matrix, int threads) {
     int num_rows = matrix.size();
-    double max_min_value = -numeric_limits<double>::infinity(); // Начальное значение для максимума
-    omp_set_num_threads(num_threads);
-    double total_time = 0.0;
-    for (int r = 0; r < num_repeats; ++r) {
-        max_min_value = -numeric_limits<double>::infinity();  // Сбрасываем максимум перед каждой итерацией
-        
-        // Начало измерения времени
-        auto start = chrono::high_resolution_clock::now();
-
-        #pragma omp parallel for reduction(max:max_min_value)
-        for (int i = 0; i < num_rows; ++i) {
-            double min_in_row = find_min_in_row(matrix[i]);
-            max_min_value = max(max_min_value, min_in_row);
-        }
+    LocatedValue<double> max_min;
 
-        // Конец измерения времени
-        auto end = chrono::high_resolution_clock::now();
-        chrono::duration<double> duration = end - start;
-        total_time += duration.count();
+    #pragma omp parallel for num_threads(threads) if(threads > 1) reduction(maxloc:max_min)
+    for (int i = 0; i < num_rows; ++i) {
+        const auto& row = matrix[i];
+        auto min_in_row = min_element(row.begin(), row.end());
+        max_min.offer_max(*min_in_row, i, [&]() { return min_in_row - row.begin(); });
     }
+    return max_min;
+}
+
+// Функция для нахождения максимального значения среди минимальных элементов строк
+// матрицы и его позиции (строка, столбец).
+// Работает как с Matrix<double>, так и с прежним vector<vector<double>> (для сравнения).
+// effective_threads - число потоков, выбранное политикой выполнения
+template <typename MatrixType>
+LocatedValue<double> find_max_of_mins(const MatrixType& matrix, const string& layout, int num_threads,
+                                      BenchmarkRunner& runner, double& avg_time, int& effective_threads) {
+    int num_rows = matrix.size();
+    LocatedValue<double> max_min;
+    // Число потоков по числу элементов матрицы, num_threads - верхняя граница
+    int threads = max_of_mins_policy.threads_for(num_rows * matrix[0].size(), num_threads);
+    BenchmarkStats stats = runner.run("max_of_mins",
+        {{"layout", layout}, {"rows", to_string(num_rows)}, {"threads", to_string(num_threads)},
+         {"effective_threads", to_string(threads)}}, [&]() {
+        max_min = max_of_row_mins(matrix, threads);
+    });
 
-    avg_time = total_time / num_repeats;
-    return max_min_value;
+    avg_time = stats.median;
+    effective_threads = threads;
+    return max_min;
 }
 
-int main() {
-    cout << "Number of Rows     | Threads    | Execution Time  | Max of Row Minimums\n";
-    cout << "---------------------------------------------------------------\n";
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    options.min_repeats = 10;
+    BenchmarkRunner runner("openmp4", parse_benchmark_options(argc, argv, options));
+
+    // --mode=layout дополнительно замеряет прежнее хранение vector<vector<double>>
+    bool compare_layouts = get_option(argc, argv, "mode", "default") == "layout";
+
     vector<int> row_counts = {1000, 5000, 10000};
     vector<int> thread_counts = {1, 2, 4, 8, 16};
     int num_cols = 100;
-    int num_repeats = 10;
+    uint64_t seed = parse_data_seed(argc, argv);
+
+    // Калибровка порога: поиск на одном потоке по матрице вне кэша L1
+    Matrix<double> sample(1 << 11, num_cols);
+    fill_uniform_ints(sample, 1, 100, seed);
+    max_of_mins_policy = make_execution_policy(argc, argv, "max_of_mins",
+        *max_element(thread_counts.begin(), thread_counts.end()), sample.rows() * sample.cols(), [&]() {
+        do_not_optimize(max_of_row_mins(sample, 1).value);
+    });
+    print_execution_policy(max_of_mins_policy);
+
+    cout << "Number of Rows     | Threads    | Effective | Median Time     | Max of Row Minimums | Position (row, col)\n";
+    cout << "-------------------------------------------------------------------------------------------------\n";
 
     // Основной цикл по размерам матриц
     for (int rows : row_counts) {
-        // Инициализация матрицы случайными числами
-        vector<vector<double>> matrix(rows, vector<double>(num_cols));
-        srand(time(0));
-        for (int i = 0; i < rows; ++i) {
-            for (int j = 0; j < num_cols; ++j) {
-                matrix[i][j] = rand() % 100 + 1;  // Заполняем матрицу числами от 1 до 100
+        // Инициализация матрицы случайными числами от 1 до 100
+        Matrix<double> matrix(rows, num_cols);
+        fill_uniform_ints(matrix, 1, 100, seed);
+
+        vector<vector<double>> nested_matrix;
+        if (compare_layouts) {
+            nested_matrix.assign(rows, vector<double>(num_cols));
+            for (int i = 0; i < rows; ++i) {
+                copy(matrix[i].begin(), matrix[i].end(), nested_matrix[i].begin());
             }
         }
 
         // Цикл по количеству потоков
         for (int threads : thread_counts) {
             double avg_time;
-            double result = find_max_of_mins(matrix, threads, num_repeats, avg_time);
+            int effective_threads;
+            LocatedValue<double> result = find_max_of_mins(matrix, "flat", threads, runner, avg_time, effective_threads);
             cout << setw(18) << rows << " | "
                  << setw(10) << threads << " | "
+                 << setw(9) << effective_threads << " | "
                  << setw(15) << avg_time << " s | "
-                 << setw(15) << result << endl;
+                 << setw(19) << result.value << " | "
+                 << "(" << result.row << ", " << result.col << ")";
+            if (compare_layouts) {
+                double nested_time;
+                find_max_of_mins(nested_matrix, "nested", threads, runner, nested_time, effective_threads);
+                cout << " | nested: " << nested_time << " s (x" << nested_time / avg_time << ")";
+            }
+            cout << endl;
         }
     }
 
@@ -3,38 +3,75 @@
 #include <omp.h>
 #include <iomanip>
 #include <algorithm>
-#include <chrono>
+#include "benchmark.h"
+#include "matrix.h"
+#include "sparse_matrix.h"
+#include "schedule.h"
+#include "data_generator.h"
+#include "execution_policy.h"
+#include "statistics.h"
 
 using namespace std;
 
+// Зерно генерируемых матриц (--seed)
+uint64_t data_seed = 1;
+
+// Элемент матрицы от 1 до 100 по его номеру k = i * cols + j
+double random_element(uint64_t k) {
+    return counter_int(data_seed, k, 1, 100);
+}
+
+// Столбцы [band_first_col, band_end_col) строки i ленты шириной band_width
+size_t band_first_col(size_t i, int band_width) {
+    return static_cast<size_t>(max(0, static_cast<int>(i) - band_width));
+}
+
+size_t band_end_col(size_t i, int cols, int band_width) {
+    return static_cast<size_t>(min(cols, static_cast<int>(i) + band_width + 1));
+}
+
 // Функция для генерации ленточной матрицы
-vector<vector<double>> generate_band_matrix(int rows, int cols, int band_width) {
-    vector<vector<double>> matrix(rows, vector<double>(cols, 0));
-    srand(time(0));
-    for (int i = 0; i < rows; ++i) {
-        // Заполнение элементов в пределах заданной ширины полосы
-        for (int j = max(0, i - band_width); j <= min(cols - 1, i + band_width); ++j) {
-            matrix[i][j] = rand() % 100 + 1;
-        }
-    }
+Matrix<double> generate_band_matrix(int rows, int cols, int band_width) {
+    Matrix<double> matrix(rows, cols, 0);
+    // Заполнение элементов в пределах заданной ширины полосы
+    parallel_fill_rows(matrix, random_element,
+                       [&](size_t i) { return band_first_col(i, band_width); },
+                       [&](size_t i) { return band_end_col(i, cols, band_width); });
     return matrix;
 }
 
 // Функция для генерации нижнетреугольной матрицы
-vector<vector<double>> generate_lower_triangular_matrix(int rows, int cols) {
-    vector<vector<double>> matrix(rows, vector<double>(cols, 0));
-    srand(time(0));
-    for (int i = 0; i < rows; ++i) {
-        // Заполнение только нижней треугольной части матрицы
-        for (int j = 0; j <= i; ++j) {
-            matrix[i][j] = rand() % 100 + 1;
-        }
-    }
+Matrix<double> generate_lower_triangular_matrix(int rows, int cols) {
+    Matrix<double> matrix(rows, cols, 0);
+    // Заполнение только нижней треугольной части матрицы
+    parallel_fill_rows(matrix, random_element, [](size_t) { return size_t(0); },
+                       [&](size_t i) { return min(static_cast<size_t>(cols), i + 1); });
     return matrix;
 }
 
+// Те же матрицы сразу в разреженных форматах, без плотной матрицы rows x cols.
+// Элементы совпадают с плотными: номер элемента k = i * cols + j тот же
+BandMatrix<double> generate_band_storage(int rows, int cols, int band_width) {
+    return BandMatrix<double>::generate(rows, cols, band_width, random_element);
+}
+
+CsrMatrix<double> generate_band_csr(int rows, int cols, int band_width) {
+    return CsrMatrix<double>::generate(rows, cols,
+                                       [&](size_t i) { return band_first_col(i, band_width); },
+                                       [&](size_t i) { return band_end_col(i, cols, band_width); }, random_element);
+}
+
+PackedLowerTriangular<double> generate_packed_triangular(int rows, int cols) {
+    return PackedLowerTriangular<double>::generate(rows, cols, random_element);
+}
+
+CsrMatrix<double> generate_triangular_csr(int rows, int cols) {
+    return CsrMatrix<double>::generate(rows, cols, [](size_t) { return size_t(0); },
+                                       [&](size_t i) { return min(static_cast<size_t>(cols), i + 1); }, random_element);
+}
+
 // Функция для поиска минимального значения в строке
-double find_min_in_row(const vector<double>& row) {
+double find_min_in_row(RowView<const double> row) {
     double min_value = numeric_limits<double>::infinity();
     for (double val : row) {
         if (val != 0) min_value = min(min_value, val);
@@ -42,100 +79,428 @@ double find_min_in_row(const vector<double>& row) {
     return min_value;
 }
 
+// Минимум хранимых значений строки разреженного формата: нулей среди них нет,
+// поэтому проверка val != 0 не нужна
+double find_min_in_stored_row(RowView<const double> row) {
+    double min_value = numeric_limits<double>::infinity();
+    for (double val : row) {
+        min_value = min(min_value, val);
+    }
+    return min_value;
+}
+
+// Минимум строки i для каждого формата хранения
+double row_minimum(const Matrix<double>& matrix, int i) {
+    return find_min_in_row(matrix[i]);
+}
+
+// Прежнее хранение vector<vector<double>> - только для --mode=layout
+double row_minimum(const vector<vector<double>>& matrix, int i) {
+    return find_min_in_row(RowView<const double>(matrix[i].data(), matrix[i].size()));
+}
+
+double row_minimum(const BandMatrix<double>& matrix, int i) {
+    return find_min_in_stored_row(matrix.row(i));
+}
+
+double row_minimum(const PackedLowerTriangular<double>& matrix, int i) {
+    return find_min_in_stored_row(matrix.row(i));
+}
+
+double row_minimum(const CsrMatrix<double>& matrix, int i) {
+    return find_min_in_stored_row(matrix.row(i));
+}
+
+// Столбец первого вхождения минимума value в строке i: номер хранимого
+// элемента переводится в столбец по правилам формата. Вызывается только для
+// строки, улучшившей результат (см. LocatedValue)
+size_t row_minimum_column(const Matrix<double>& matrix, int i, double value) {
+    RowView<const double> row = matrix[i];
+    return find(row.begin(), row.end(), value) - row.begin();
+}
+
+size_t row_minimum_column(const vector<vector<double>>& matrix, int i, double value) {
+    return find(matrix[i].begin(), matrix[i].end(), value) - matrix[i].begin();
+}
+
+size_t row_minimum_column(const BandMatrix<double>& matrix, int i, double value) {
+    RowView<const double> row = matrix.row(i);
+    return matrix.first_col(i) + (find(row.begin(), row.end(), value) - row.begin());
+}
+
+size_t row_minimum_column(const PackedLowerTriangular<double>& matrix, int i, double value) {
+    RowView<const double> row = matrix.row(i);
+    return find(row.begin(), row.end(), value) - row.begin();
+}
+
+size_t row_minimum_column(const CsrMatrix<double>& matrix, int i, double value) {
+    RowView<const double> row = matrix.row(i);
+    return matrix.row_columns(i)[find(row.begin(), row.end(), value) - row.begin()];
+}
+
+// Протяжённость ненулевой части строки: от первого до последнего ненулевого
+// элемента включительно (0 для нулевой строки)
+double nonzero_extent(RowView<const double> row) {
+    const double* first = find_if(row.begin(), row.end(), [](double val) { return val != 0; });
+    if (first == row.end()) return 0.0;
+    const double* last = row.end();
+    while (*(last - 1) == 0) --last;
+    return static_cast<double>(last - first);
+}
+
+// Модель стоимости строки для сбалансированного разбиения: сколько ненулевых
+// элементов обрабатывает row_minimum. В плотной строке это её ненулевая часть
+// (у треугольной матрицы - i + 1 элементов, у ленточной - ширина ленты), а не
+// все cols, иначе разбиение совпало бы с равномерным static. В разреженных
+// форматах - хранимые элементы
+double row_cost(const Matrix<double>& matrix, int i) {
+    return nonzero_extent(matrix[i]);
+}
+
+double row_cost(const vector<vector<double>>& matrix, int i) {
+    return nonzero_extent(RowView<const double>(matrix[i].data(), matrix[i].size()));
+}
+
+template <typename MatrixType>
+double row_cost(const MatrixType& matrix, int i) {
+    return matrix.row(i).size();
+}
+
+// Число элементов, которые просматривает поиск по всей матрице (объём задачи
+// для политики выполнения). Плотная строка читается целиком, включая нули
+template <typename MatrixType>
+size_t scanned_elements(const MatrixType& matrix) {
+    double total = 0.0;
+    for (int i = 0; i < static_cast<int>(matrix.size()); ++i) {
+        total += row_cost(matrix, i);
+    }
+    return static_cast<size_t>(total);
+}
+
+size_t scanned_elements(const Matrix<double>& matrix) {
+    return matrix.rows() * matrix.cols();
+}
+
+size_t scanned_elements(const vector<vector<double>>& matrix) {
+    size_t total = 0;
+    for (const vector<double>& row : matrix) total += row.size();
+    return total;
+}
+
+// Политика выполнения поиска, калибруется в main
+ExecutionPolicy max_of_mins_policy;
+
+// Число потоков для поиска по matrix: выбирается политикой по объёму
+// просматриваемых элементов, requested - верхняя граница. Считается один раз
+// до замера, а не в каждом повторе: для ленточного формата и CSR проход по
+// строкам в scanned_elements сравним с самим поиском
+template <typename MatrixType>
+int max_of_mins_threads(const MatrixType& matrix, int requested) {
+    return max_of_mins_policy.threads_for(scanned_elements(matrix), requested);
+}
+
+// Разбиение строк на num_parts непрерывных диапазонов равной стоимости по
+// префиксным суммам: граница k - первая строка, на которой накопленная
+// стоимость достигает k / num_parts от общей. Диапазон части t:
+// [bounds[t], bounds[t + 1])
+template <typename MatrixType>
+vector<int> build_balanced_partition(const MatrixType& matrix, int num_parts) {
+    int num_rows = matrix.size();
+    vector<double> prefix(num_rows + 1, 0.0);
+    for (int i = 0; i < num_rows; ++i) {
+        prefix[i + 1] = prefix[i] + row_cost(matrix, i);
+    }
+
+    vector<int> bounds(num_parts + 1, num_rows);
+    bounds[0] = 0;
+    for (int k = 1; k < num_parts; ++k) {
+        double target = prefix[num_rows] * k / num_parts;
+        bounds[k] = lower_bound(prefix.begin(), prefix.end(), target) - prefix.begin();
+        bounds[k] = max(bounds[k], bounds[k - 1]);
+    }
+    return bounds;
+}
+
 // Функция для поиска максимального значения среди минимальных в строках матрицы
-double find_max_of_mins(const vector<vector<double>>& matrix, int num_threads, const string& schedule_type, int chunk_size, double& execution_time) {
+// и его позиции (строка, столбец).
+// schedule_type - имя распределения для schedule(runtime) (см. schedule.h) или
+// "balanced"; для "balanced" используется заранее построенное разбиение
+// partition (если оно не передано, строится здесь же).
+// threads - размер команды как есть: политику выполнения применяет вызывающий
+// код (max_of_mins_threads), чтобы знать и печатать фактическое число потоков
+template <typename MatrixType>
+LocatedValue<double> find_max_of_mins(const MatrixType& matrix, int threads, const string& schedule_type,
+                                      int chunk_size, const vector<int>& partition = vector<int>()) {
     int num_rows = matrix.size();
-    double max_min_value = -numeric_limits<double>::infinity();
+    LocatedValue<double> max_min;
 
-    // Начало измерения времени
-    auto start = chrono::high_resolution_clock::now();
+    if (schedule_type == "balanced") {
+        vector<int> local_partition;
+        if (partition.empty()) local_partition = build_balanced_partition(matrix, threads);
+        const vector<int>& bounds = partition.empty() ? local_partition : partition;
+        int num_parts = bounds.size() - 1;
 
-    omp_set_num_threads(num_threads);
+        #pragma omp parallel num_threads(threads) if(threads > 1) reduction(maxloc:max_min)
+        {
+            // Если команда меньше числа частей, поток берёт части по кругу
+            for (int part = omp_get_thread_num(); part < num_parts; part += omp_get_num_threads()) {
+                for (int i = bounds[part]; i < bounds[part + 1]; ++i) {
+                    double min_in_row = row_minimum(matrix, i);
+                    max_min.offer_max(min_in_row, i, [&]() { return row_minimum_column(matrix, i, min_in_row); });
+                }
+            }
+        }
+    } else {
+        // Любое распределение из schedule.h, "runtime" - уже заданное
+        // через omp_set_schedule или OMP_SCHEDULE
+        if (schedule_type != "runtime" && !set_runtime_schedule(schedule_type, chunk_size)) {
+            return max_min;
+        }
 
-    if (schedule_type == "static") {
-        #pragma omp parallel for schedule(static, chunk_size) reduction(max:max_min_value)
+        #pragma omp parallel for num_threads(threads) if(threads > 1) schedule(runtime) reduction(maxloc:max_min)
         for (int i = 0; i < num_rows; ++i) {
-            double min_in_row = find_min_in_row(matrix[i]);
-            max_min_value = max(max_min_value, min_in_row);
+            double min_in_row = row_minimum(matrix, i);
+            max_min.offer_max(min_in_row, i, [&]() { return row_minimum_column(matrix, i, min_in_row); });
         }
-    } else if (schedule_type == "dynamic") {
-        #pragma omp parallel for schedule(dynamic, chunk_size) reduction(max:max_min_value)
-        for (int i = 0; i < num_rows; ++i) {
-            double min_in_row = find_min_in_row(matrix[i]);
-            max_min_value = max(max_min_value, min_in_row);
+    }
+
+    return max_min;
+}
+
+// Замер одного формата хранения: объём памяти, время и результат
+template <typename MatrixType>
+void run_format(const string& matrix_type, const string& format, const MatrixType& matrix, int size, int threads,
+                const string& schedule_type, int chunk_size, BenchmarkRunner& runner) {
+    LocatedValue<double> result;
+    int effective_threads = max_of_mins_threads(matrix, threads);
+    vector<int> partition;
+    if (schedule_type == "balanced") partition = build_balanced_partition(matrix, effective_threads);
+    BenchmarkStats stats = runner.run("max_of_mins_format",
+        {{"matrix", matrix_type}, {"format", format}, {"size", to_string(size)}, {"threads", to_string(threads)},
+         {"effective_threads", to_string(effective_threads)},
+         {"schedule", schedule_type}, {"chunk", to_string(chunk_size)}}, [&]() {
+        result = find_max_of_mins(matrix, effective_threads, schedule_type, chunk_size, partition);
+    });
+
+    cout << setw(13) << matrix_type << " | "
+         << setw(10) << format << " | "
+         << setw(6) << size << " | "
+         << setw(7) << threads << " | "
+         << setw(9) << effective_threads << " | "
+         << setw(10) << matrix.memory_bytes() / (1024.0 * 1024.0) << " | "
+         << setw(10) << schedule_type << " | "
+         << setw(10) << stats.median << " | "
+         << setw(10) << stats.p95 << " | "
+         << setw(8) << result.value << " | (" << result.row << ", " << result.col << ")\n";
+}
+
+// Сравнение плотного хранения с ленточным, упакованным треугольным и CSR
+void compare_formats(const vector<int>& matrix_sizes, const vector<int>& thread_counts, int band_width,
+                     const string& schedule_type, int chunk_size, BenchmarkRunner& runner) {
+    cout << "Matrix Type   | Format     | Size   | Threads | Effective | Memory(MB) | Schedule   | Median (s) | P95 (s)    | Result   | Position\n";
+    cout << "---------------------------------------------------------------------------------------------------------------------------------\n";
+
+    for (int size : matrix_sizes) {
+        Matrix<double> band_matrix = generate_band_matrix(size, size, band_width);
+        Matrix<double> lower_triangular_matrix = generate_lower_triangular_matrix(size, size);
+        BandMatrix<double> band_storage = generate_band_storage(size, size, band_width);
+        CsrMatrix<double> band_csr = generate_band_csr(size, size, band_width);
+        PackedLowerTriangular<double> packed_triangular = generate_packed_triangular(size, size);
+        CsrMatrix<double> triangular_csr = generate_triangular_csr(size, size);
+
+        for (int threads : thread_counts) {
+            run_format("Band", "dense", band_matrix, size, threads, schedule_type, chunk_size, runner);
+            run_format("Band", "banded", band_storage, size, threads, schedule_type, chunk_size, runner);
+            run_format("Band", "csr", band_csr, size, threads, schedule_type, chunk_size, runner);
+            run_format("Triangular", "dense", lower_triangular_matrix, size, threads, schedule_type, chunk_size, runner);
+            run_format("Triangular", "packed", packed_triangular, size, threads, schedule_type, chunk_size, runner);
+            run_format("Triangular", "csr", triangular_csr, size, threads, schedule_type, chunk_size, runner);
         }
-    } else if (schedule_type == "guided") {
-        #pragma omp parallel for schedule(guided, chunk_size) reduction(max:max_min_value)
-        for (int i = 0; i < num_rows; ++i) {
-            double min_in_row = find_min_in_row(matrix[i]);
-            max_min_value = max(max_min_value, min_in_row);
+    }
+}
+
+// Сравнение распределений на треугольной матрице, где стоимость строки
+// растёт линейно с её номером: медиана и хвост (p95) по повторам
+void compare_balance(const vector<int>& matrix_sizes, const vector<int>& thread_counts, const vector<string>& schedules,
+                     int chunk_size, BenchmarkRunner& runner) {
+    cout << "Matrix Type   | Format     | Size   | Threads | Effective | Memory(MB) | Schedule   | Median (s) | P95 (s)    | Result   | Position\n";
+    cout << "---------------------------------------------------------------------------------------------------------------------------------\n";
+
+    for (int size : matrix_sizes) {
+        PackedLowerTriangular<double> packed_triangular = generate_packed_triangular(size, size);
+
+        for (int threads : thread_counts) {
+            for (const string& schedule_type : schedules) {
+                run_format("Triangular", "packed", packed_triangular, size, threads, schedule_type, chunk_size, runner);
+            }
         }
     }
+}
 
-    // Конец измерения времени
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
-    execution_time = duration.count();
+// Сравнение Matrix<double> с прежним хранением vector<vector<double>> на тех
+// же данных и распределении: каждая строка вложенного вектора - отдельное
+// выделение памяти, строки не лежат подряд
+void compare_layouts(const vector<int>& matrix_sizes, const vector<int>& thread_counts, int band_width,
+                     const string& schedule_type, int chunk_size, BenchmarkRunner& runner) {
+    cout << "Matrix Type   | Size   | Threads | Effective | Flat (s)   | Nested (s) | Nested/Flat | Result\n";
+    cout << "-------------------------------------------------------------------------------------------------\n";
 
-    return max_min_value;
+    for (int size : matrix_sizes) {
+        vector<pair<string, Matrix<double>>> matrices;
+        matrices.emplace_back("Band", generate_band_matrix(size, size, band_width));
+        matrices.emplace_back("Triangular", generate_lower_triangular_matrix(size, size));
+
+        for (const auto& entry : matrices) {
+            const Matrix<double>& flat = entry.second;
+            vector<vector<double>> nested(flat.rows());
+            for (size_t i = 0; i < flat.rows(); ++i) {
+                nested[i].assign(flat[i].begin(), flat[i].end());
+            }
+
+            for (int threads : thread_counts) {
+                int effective_threads = max_of_mins_threads(flat, threads);
+                BenchmarkParams params = {{"matrix", entry.first}, {"size", to_string(size)},
+                                          {"threads", to_string(threads)},
+                                          {"effective_threads", to_string(effective_threads)},
+                                          {"schedule", schedule_type}};
+                LocatedValue<double> flat_result, nested_result;
+                BenchmarkParams flat_params = params;
+                flat_params.push_back({"layout", "flat"});
+                double flat_time = runner.run("max_of_mins_layout", flat_params, [&]() {
+                    flat_result = find_max_of_mins(flat, effective_threads, schedule_type, chunk_size);
+                }).median;
+                BenchmarkParams nested_params = params;
+                nested_params.push_back({"layout", "nested"});
+                double nested_time = runner.run("max_of_mins_layout", nested_params, [&]() {
+                    nested_result = find_max_of_mins(nested, effective_threads, schedule_type, chunk_size);
+                }).median;
+
+                cout << setw(13) << entry.first << " | "
+                     << setw(6) << size << " | "
+                     << setw(7) << threads << " | "
+                     << setw(9) << effective_threads << " | "
+                     << setw(10) << flat_time << " | "
+                     << setw(10) << nested_time << " | "
+                     << setw(11) << nested_time / flat_time << " | "
+                     << flat_result.value << " | (" << flat_result.row << ", " << flat_result.col << ")"
+                     << (nested_result.value == flat_result.value && nested_result.row == flat_result.row &&
+                         nested_result.col == flat_result.col ? "" : " MISMATCH") << "\n";
+            }
+        }
+    }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    options.min_repeats = 3;
+    BenchmarkRunner runner("openmp5", parse_benchmark_options(argc, argv, options));
+    data_seed = parse_data_seed(argc, argv);
+
     vector<int> matrix_sizes = {1000, 2000, 3000};
     vector<int> thread_counts = {2, 4, 8};
-    int num_repeats = 3;
     int band_width = 5;
     int chunk_size = 10;
-    vector<string> schedules = {"static", "dynamic", "guided"};
+    vector<string> schedules = {"static", "dynamic", "guided", "balanced"};
+
+    // Калибровка порога: поиск на одном потоке по плотной треугольной матрице
+    Matrix<double> sample = generate_lower_triangular_matrix(512, 512);
+    max_of_mins_policy = make_execution_policy(argc, argv, "max_of_mins",
+        *max_element(thread_counts.begin(), thread_counts.end()), scanned_elements(sample), [&]() {
+        do_not_optimize(find_max_of_mins(sample, 1, "static", 0).value);
+    });
+    print_execution_policy(max_of_mins_policy);
+
+    // --mode=formats сравнивает форматы хранения (распределение задаётся --schedule=),
+    // --mode=balance - распределения на упакованной треугольной матрице,
+    // --mode=layout - Matrix<double> с прежним vector<vector<double>>
+    string mode = get_option(argc, argv, "mode", "default");
+    if (mode == "layout") {
+        compare_layouts(matrix_sizes, thread_counts, band_width,
+                        get_option(argc, argv, "schedule", "static"), chunk_size, runner);
+        return 0;
+    }
+    if (mode == "formats") {
+        compare_formats(matrix_sizes, thread_counts, band_width,
+                        get_option(argc, argv, "schedule", "static"), chunk_size, runner);
+        return 0;
+    }
+    if (mode == "balance") {
+        compare_balance(matrix_sizes, thread_counts, schedules, chunk_size, runner);
+        return 0;
+    }
+    // --mode=sweep перебирает --kinds= x --chunks= x --threads= и ищет лучшее
+    // распределение для каждой матрицы. Число потоков - измерение сетки,
+    // поэтому политика выполнения здесь не применяется
+    if (mode == "sweep") {
+        ScheduleGrid grid = parse_schedule_grid(argc, argv, thread_counts);
+        print_sweep_header();
+        for (int size : matrix_sizes) {
+            Matrix<double> band_matrix = generate_band_matrix(size, size, band_width);
+            Matrix<double> lower_triangular_matrix = generate_lower_triangular_matrix(size, size);
+            sweep_schedules(runner, "max_of_mins_sweep", "band " + to_string(size), grid, [&](int threads) {
+                find_max_of_mins(band_matrix, threads, "runtime", 0);
+            });
+            sweep_schedules(runner, "max_of_mins_sweep", "triangular " + to_string(size), grid, [&](int threads) {
+                find_max_of_mins(lower_triangular_matrix, threads, "runtime", 0);
+            });
+        }
+        return 0;
+    }
 
-    cout << "Matrix Type   | Size   | Threads | Distribution  | Time (sec)  | Result\n";
-    cout << "----------------------------------------------------------------------------\n";
+    cout << "Matrix Type   | Size   | Threads | Effective | Distribution  | Median (sec)| P95 (sec)  | Result   | Position\n";
+    cout << "----------------------------------------------------------------------------------------------------------------\n";
 
     // Тесты для ленточной матрицы
     for (int size : matrix_sizes) {
-        vector<vector<double>> band_matrix = generate_band_matrix(size, size, band_width);
-        vector<vector<double>> lower_triangular_matrix = generate_lower_triangular_matrix(size, size);
+        Matrix<double> band_matrix = generate_band_matrix(size, size, band_width);
+        Matrix<double> lower_triangular_matrix = generate_lower_triangular_matrix(size, size);
 
         for (int threads : thread_counts) {
             for (const string& schedule_type : schedules) {
-                double total_time = 0;
-                double result = 0;
+                LocatedValue<double> result;
+                int effective_threads = max_of_mins_threads(band_matrix, threads);
+                vector<int> partition;
+                if (schedule_type == "balanced") partition = build_balanced_partition(band_matrix, effective_threads);
+                BenchmarkStats stats = runner.run("max_of_mins",
+                    {{"matrix", "band"}, {"size", to_string(size)}, {"threads", to_string(threads)},
+                     {"effective_threads", to_string(effective_threads)},
+                     {"schedule", schedule_type}, {"chunk", to_string(chunk_size)}}, [&]() {
+                    result = find_max_of_mins(band_matrix, effective_threads, schedule_type, chunk_size, partition);
+                });
 
-                for (int i = 0; i < num_repeats; ++i) {
-                    double execution_time;
-                    result = find_max_of_mins(band_matrix, threads, schedule_type, chunk_size, execution_time);
-                    total_time += execution_time;
-                }
-
-                double avg_time = total_time / num_repeats;
                 cout << setw(13) << "Band" << " | "
                      << setw(6) << size << " | "
                      << setw(7) << threads << " | "
+                     << setw(9) << effective_threads << " | "
                      << setw(12) << schedule_type << " | "
-                     << setw(10) << avg_time << " | "
-                     << setw(8) << result << "\n";
+                     << setw(10) << stats.median << " | "
+                     << setw(10) << stats.p95 << " | "
+                     << setw(8) << result.value << " | (" << result.row << ", " << result.col << ")\n";
             }
         }
 
         // Тесты для нижнетреугольной матрицы
         for (int threads : thread_counts) {
             for (const string& schedule_type : schedules) {
-                double total_time = 0;
-                double result = 0;
-
-                for (int i = 0; i < num_repeats; ++i) {
-                    double execution_time;
-                    result = find_max_of_mins(lower_triangular_matrix, threads, schedule_type, chunk_size, execution_time);
-                    total_time += execution_time;
-                }
+                LocatedValue<double> result;
+                int effective_threads = max_of_mins_threads(lower_triangular_matrix, threads);
+                vector<int> partition;
+                if (schedule_type == "balanced") partition = build_balanced_partition(lower_triangular_matrix, effective_threads);
+                BenchmarkStats stats = runner.run("max_of_mins",
+                    {{"matrix", "triangular"}, {"size", to_string(size)}, {"threads", to_string(threads)},
+                     {"effective_threads", to_string(effective_threads)},
+                     {"schedule", schedule_type}, {"chunk", to_string(chunk_size)}}, [&]() {
+                    result = find_max_of_mins(lower_triangular_matrix, effective_threads, schedule_type, chunk_size, partition);
+                });
 
-                double avg_time = total_time / num_repeats;
                 cout << setw(13) << "Triangular" << " | "
                      << setw(6) << size << " | "
                      << setw(7) << threads << " | "
+                     << setw(9) << effective_threads << " | "
                      << setw(12) << schedule_type << " | "
-                     << setw(10) << avg_time << " | "
-                     << setw(8) << result << "\n";
+                     << setw(10) << stats.median << " | "
+                     << setw(10) << stats.p95 << " | "
+                     << setw(8) << result.value << " | (" << result.row << ", " << result.col << ")\n";
             }
         }
     }
@@ -1,70 +1,205 @@
 #include <iostream>
 #include <omp.h>
 #include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
-#include <chrono>
 #include <iomanip>
+#include "benchmark.h"
+#include "schedule.h"
+#include "counter_rng.h"
+#include "work_stealing.h"
 
 using namespace std;
 
-// Имитация ресурсоемкой вычислительной задачи
-void heavy_computation(int i) {
-    int iterations = rand() % 1000 + 1;
+// Распределение стоимости итераций
+enum class CostDistribution {
+    Uniform,      // равномерно от 1 до max_cost (как прежний rand() % 1000 + 1)
+    HeavyTailed,  // распределение Парето: редкие итерации во много раз дороже средних
+    Increasing,   // стоимость растёт линейно с номером итерации
+    Bursty        // дешёвые итерации с редкими блоками дорогих подряд
+};
+
+bool parse_cost_distribution(const string& name, CostDistribution& distribution) {
+    if (name == "uniform") distribution = CostDistribution::Uniform;
+    else if (name == "heavy-tailed") distribution = CostDistribution::HeavyTailed;
+    else if (name == "increasing") distribution = CostDistribution::Increasing;
+    else if (name == "bursty") distribution = CostDistribution::Bursty;
+    else return false;
+    return true;
+}
+
+// Детерминированная нагрузка: стоимость итерации i вычисляется счётчиковым
+// генератором из (seed, i), поэтому она одинакова при любом числе потоков
+// и распределении итераций, а потоки не конкурируют за общее состояние rand()
+struct Workload {
+    CostDistribution distribution = CostDistribution::Uniform;
+    uint64_t seed = 1;
+    int num_iterations = 10000;
+    int max_cost = 1000;
+
+    int cost(int i) const {
+        switch (distribution) {
+        case CostDistribution::Uniform:
+            return counter_int(seed, i, 1, max_cost);
+        case CostDistribution::HeavyTailed: {
+            // Парето с alpha = 1.5 и средним около max_cost / 2, хвост ограничен 100 * max_cost
+            double u = 1.0 - counter_uniform(seed, i);
+            double value = max_cost / 6.0 / pow(u, 1.0 / 1.5);
+            return static_cast<int>(min(value, 100.0 * max_cost)) + 1;
+        }
+        case CostDistribution::Increasing:
+            return 1 + static_cast<int>(static_cast<long long>(max_cost - 1) * i / max(num_iterations - 1, 1));
+        case CostDistribution::Bursty: {
+            // Блоки по 64 итерации, 5% блоков дорогие
+            const int block = 64;
+            bool burst = counter_uniform(seed ^ 0xB5ull, i / block) < 0.05;
+            return burst ? counter_int(seed, i, 5 * max_cost, 10 * max_cost) : counter_int(seed, i, 1, max_cost / 10);
+        }
+        }
+        return 1;
+    }
+};
+
+// Имитация ресурсоемкой вычислительной задачи; возвращает число выполненных шагов
+int heavy_computation(const Workload& workload, int i) {
+    int iterations = workload.cost(i);
     double sum = 0;
     for (int j = 0; j < iterations; ++j) {
         sum += j * 0.0001;
     }
+    do_not_optimize(sum);
+    return iterations;
 }
 
-// Функция для тестирования различных типов распределения итераций
-void test_schedule(int num_threads, int num_iterations, const string& schedule_type, int chunk_size) {
-
-    omp_set_num_threads(num_threads);
-
-    // Начало измерения времени
-    auto start = chrono::high_resolution_clock::now();
-
-    // Выполняем цикл с различными типами распределения итераций
-    if (schedule_type == "static") {
-        #pragma omp parallel for schedule(static, chunk_size)
+// Один проход цикла по итерациям нагрузки; возвращает сумму body(i).
+// schedule_type: "work-stealing" - исполнитель из work_stealing.h,
+// "taskloop" - omp taskloop с grainsize(chunk_size), иначе omp for с
+// распределением, уже заданным через omp_set_schedule (schedule(runtime))
+template <typename Body>
+long long run_loop(const string& schedule_type, int num_iterations, int chunk_size, int num_threads, Body&& body) {
+    long long total = 0;
+    if (schedule_type == "work-stealing") {
+        total = work_stealing_reduce<long long>(num_iterations, chunk_size, num_threads, 0LL, body);
+    } else if (schedule_type == "taskloop") {
+        #pragma omp parallel
+        #pragma omp single
+        #pragma omp taskloop grainsize(chunk_size) reduction(+:total)
         for (int i = 0; i < num_iterations; ++i) {
-            heavy_computation(i);
+            total += body(i);
         }
-    } else if (schedule_type == "dynamic") {
-        #pragma omp parallel for schedule(dynamic, chunk_size)
+    } else {
+        #pragma omp parallel for schedule(runtime) reduction(+:total)
         for (int i = 0; i < num_iterations; ++i) {
-            heavy_computation(i);
-        }
-    } else if (schedule_type == "guided") {
-        #pragma omp parallel for schedule(guided, 100)
-        for (int i = 0; i < num_iterations; ++i) {
-            heavy_computation(i);
+            total += body(i);
         }
     }
+    return total;
+}
 
-    // Конец измерения времени
-    auto end = chrono::high_resolution_clock::now();
-    chrono::duration<double> duration = end - start;
+// Один проход нагрузки с распределением из schedule(runtime). Возвращает
+// общее число шагов - контрольную сумму, не зависящую от числа потоков
+long long run_workload(const Workload& workload) {
+    return run_loop("runtime", workload.num_iterations, 0, omp_get_max_threads(), [&](int i) {
+        return heavy_computation(workload, i);
+    });
+}
 
-    cout << "Mode: " << setw(7) << schedule_type
+// Счётчик времени отдельного потока на своей кэш-линии
+struct alignas(64) ThreadBusyTime {
+    double seconds = 0.0;
+};
+
+// Отдельный инструментированный прогон: время полезной работы каждого
+// потока (сумма времён итераций) и простоя (остаток от времени всего цикла)
+void report_thread_activity(const string& schedule_type, const Workload& workload, int chunk_size, int num_threads) {
+    vector<ThreadBusyTime> busy(num_threads);
+    double start = omp_get_wtime();
+    run_loop(schedule_type, workload.num_iterations, chunk_size, num_threads, [&](int i) {
+        double t0 = omp_get_wtime();
+        int work = heavy_computation(workload, i);
+        busy[omp_get_thread_num()].seconds += omp_get_wtime() - t0;
+        return work;
+    });
+    double wall = omp_get_wtime() - start;
+
+    cout << "      busy/idle (ms):";
+    for (int t = 0; t < num_threads; ++t) {
+        cout << " " << t << ": " << busy[t].seconds * 1e3 << "/" << max(0.0, wall - busy[t].seconds) * 1e3;
+    }
+    cout << "\n";
+}
+
+// Функция для тестирования различных типов распределения итераций
+void test_schedule(int num_threads, const Workload& workload, const string& distribution, const string& schedule_type,
+                   int chunk_size, bool show_activity, BenchmarkRunner& runner) {
+
+    omp_set_num_threads(num_threads);
+    bool custom = schedule_type == "work-stealing" || schedule_type == "taskloop";
+    if (!custom && !set_runtime_schedule(schedule_type, chunk_size)) return;
+
+    long long total_work = 0;
+    BenchmarkStats stats = runner.run("schedule",
+        {{"threads", to_string(num_threads)}, {"iterations", to_string(workload.num_iterations)},
+         {"distribution", distribution}, {"schedule", schedule_type}, {"chunk", to_string(chunk_size)}}, [&]() {
+        // Выполняем цикл с заданным распределением итераций
+        total_work = run_loop(schedule_type, workload.num_iterations, chunk_size, num_threads, [&](int i) {
+            return heavy_computation(workload, i);
+        });
+    });
+
+    cout << "Mode: " << setw(13) << schedule_type
          << " | Number of threads: " << setw(2) << num_threads
-         << " | Execution time: " << setw(10) << duration.count() << " sec\n";
+         << " | Median time: " << setw(10) << stats.median << " sec"
+         << " | Work: " << total_work << "\n";
+
+    if (show_activity) {
+        report_thread_activity(schedule_type, workload, chunk_size, num_threads);
+    }
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    BenchmarkRunner runner("openmp6", parse_benchmark_options(argc, argv));
+
     int num_iterations = 10000;
     int chunk_size = 10;
     vector<int> thread_counts = {2, 4, 8};
 
-    cout << "Experimenting with iteration scheduling modes:\n";
+    // --distribution=uniform|heavy-tailed|increasing|bursty, --seed=N
+    string distribution = get_option(argc, argv, "distribution", "uniform");
+    Workload workload;
+    workload.num_iterations = num_iterations;
+    workload.seed = strtoull(get_option(argc, argv, "seed", "1").c_str(), nullptr, 10);
+    if (!parse_cost_distribution(distribution, workload.distribution)) {
+        cerr << "Unknown distribution: " << distribution << endl;
+        return 1;
+    }
+
+    // --mode=sweep перебирает --kinds= x --chunks= x --threads= и ищет лучшее распределение
+    if (get_option(argc, argv, "mode", "default") == "sweep") {
+        ScheduleGrid grid = parse_schedule_grid(argc, argv, thread_counts);
+        print_sweep_header();
+        sweep_schedules(runner, "schedule_sweep", distribution, grid, [&](int) {
+            do_not_optimize(run_workload(workload));
+        });
+        return 0;
+    }
+
+    // --activity=0 отключает отчёт о занятости потоков
+    bool show_activity = get_option(argc, argv, "activity", "1") != "0";
+
+    cout << "Experimenting with iteration scheduling modes (" << distribution << " cost):\n";
     cout << "---------------------------------------------------\n";
 
     // Перебираем разные варианты числа потоков и распределения итераций
     for (int num_threads : thread_counts) {
         cout << "Number of threads: " << num_threads << "\n";
-        test_schedule(num_threads, num_iterations, "static", chunk_size);
-        test_schedule(num_threads, num_iterations, "dynamic", chunk_size);
-        test_schedule(num_threads, num_iterations, "guided", chunk_size);
+        test_schedule(num_threads, workload, distribution, "static", chunk_size, show_activity, runner);
+        test_schedule(num_threads, workload, distribution, "dynamic", chunk_size, show_activity, runner);
+        test_schedule(num_threads, workload, distribution, "guided", chunk_size, show_activity, runner);
+        test_schedule(num_threads, workload, distribution, "work-stealing", chunk_size, show_activity, runner);
+        test_schedule(num_threads, workload, distribution, "taskloop", chunk_size, show_activity, runner);
         cout << "---------------------------------------------------\n";
     }
 
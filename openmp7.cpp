@@ -1,111 +1,400 @@
 #include <iostream>
 #include <omp.h>
 #include <vector>
-#include <chrono>
+#include <string>
+#include <atomic>
 #include <iomanip>
+#include <algorithm>
+#include "benchmark.h"
+#include "perf_counters.h"
+#include "data_generator.h"
+#include "execution_policy.h"
 
 using namespace std;
 
-// Инициализация вектора случайными значениями от 0 до 99
+// Инициализация вектора случайными значениями от 0 до 99 (зерно --seed)
+uint64_t data_seed = 1;
+
 void initialize_vector(vector<int>& vec) {
-    for (size_t i = 0; i < vec.size(); ++i) {
-        vec[i] = rand() % 100;
+    fill_uniform_ints(vec, 0, 99, data_seed);
+}
+
+// Имитация локальной работы между обновлениями общей суммы: work единиц
+// на каждое обновление. Чем больше work, тем ниже доля синхронизации
+inline int local_work(int value, int work) {
+    if (work > 0) {
+        unsigned x = value;
+        for (int k = 0; k < work; ++k) {
+            x = x * 1103515245u + 12345u;
+        }
+        do_not_optimize(x);
     }
+    return value;
+}
+
+// Все варианты суммирования возвращают результат, чтобы его можно было сверить
+// с последовательным эталоном. Sum - тип накопителя: int (как в исходных
+// вариантах, переполняется на больших векторах) или long long
+// (--accumulator=int32|int64). num_threads - число потоков, уже выбранное
+// политикой выполнения варианта (execution_policy.h); при num_threads = 1
+// цикл выполняется без входа в параллельную область.
+
+// Последовательный эталон (всегда в 64 битах)
+long long reduction_serial(const vector<int>& vec) {
+    long long sum = 0;
+    for (int value : vec) {
+        sum += value;
+    }
+    return sum;
 }
 
 // Суммирование элементов с использованием атомарной операции
-double reduction_atomic(const vector<int>& vec, int num_threads) {
-    int sum = 0;
-    omp_set_num_threads(num_threads);
-    auto start = chrono::high_resolution_clock::now();
+template <typename Sum>
+Sum reduction_atomic(const vector<int>& vec, int num_threads, int work) {
+    Sum sum = 0;
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(num_threads) if(num_threads > 1)
     for (size_t i = 0; i < vec.size(); ++i) {
+        int value = local_work(vec[i], work);
         #pragma omp atomic  // Атомарное сложение
-        sum += vec[i];
+        sum += value;
     }
-
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+    return sum;
 }
 
 // Суммирование элементов с использованием критической секции
-double reduction_critical(const vector<int>& vec, int num_threads) {
-    int sum = 0;
-    omp_set_num_threads(num_threads);
-    auto start = chrono::high_resolution_clock::now();
+template <typename Sum>
+Sum reduction_critical(const vector<int>& vec, int num_threads, int work) {
+    Sum sum = 0;
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(num_threads) if(num_threads > 1)
     for (size_t i = 0; i < vec.size(); ++i) {
+        int value = local_work(vec[i], work);
         #pragma omp critical  // Синхронизация потоков через критическую секцию
-        sum += vec[i];
+        sum += value;
     }
-
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+    return sum;
 }
 
 // Суммирование элементов с использованием замков
-double reduction_lock(const vector<int>& vec, int num_threads) {
-    int sum = 0;
+template <typename Sum>
+Sum reduction_lock(const vector<int>& vec, int num_threads, int work) {
+    Sum sum = 0;
     omp_lock_t lock;  // Инициализация замка
     omp_init_lock(&lock);
-    omp_set_num_threads(num_threads);
-    auto start = chrono::high_resolution_clock::now();
 
-    #pragma omp parallel for
+    #pragma omp parallel for num_threads(num_threads) if(num_threads > 1)
     for (size_t i = 0; i < vec.size(); ++i) {
+        int value = local_work(vec[i], work);
         omp_set_lock(&lock);  // Захват замка
-        sum += vec[i];
+        sum += value;
         omp_unset_lock(&lock);  // Освобождение замка
     }
 
     omp_destroy_lock(&lock);
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+    return sum;
 }
 
 // Суммирование элементов с использованием встроенной конструкции редукции
-double reduction_builtin(const vector<int>& vec, int num_threads) {
-    int sum = 0;
-    omp_set_num_threads(num_threads);
-    auto start = chrono::high_resolution_clock::now();
+template <typename Sum>
+Sum reduction_builtin(const vector<int>& vec, int num_threads, int work) {
+    Sum sum = 0;
 
-    #pragma omp parallel for reduction(+:sum)
+    #pragma omp parallel for num_threads(num_threads) if(num_threads > 1) reduction(+:sum)
     for (size_t i = 0; i < vec.size(); ++i) {
-        sum += vec[i];
+        sum += local_work(vec[i], work);
+    }
+    return sum;
+}
+
+// Ячейка счётчика, занимающая целую кэш-линию
+template <typename T>
+struct alignas(64) PaddedSlot {
+    T value = 0;
+};
+
+// Суммирование в ячейки потоков, выровненные по кэш-линиям: каждый поток
+// обновляет только свою ячейку, ложного разделения нет, итог - сумма ячеек
+template <typename Sum>
+Sum reduction_padded_slots(const vector<int>& vec, int num_threads, int work) {
+    vector<PaddedSlot<Sum>> slots(num_threads);
+
+    #pragma omp parallel num_threads(num_threads) if(num_threads > 1)
+    {
+        PaddedSlot<Sum>& slot = slots[omp_get_thread_num()];
+
+        #pragma omp for
+        for (size_t i = 0; i < vec.size(); ++i) {
+            slot.value += local_work(vec[i], work);
+        }
     }
 
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+    Sum sum = 0;
+    for (const PaddedSlot<Sum>& slot : slots) {
+        sum += slot.value;
+    }
+    return sum;
 }
 
-int main() {
-    const vector<int> thread_counts = {2, 4, 8, 16};
-    const vector<int> vector_sizes = {10000, 100000, 1000000};
+// Шардированный счётчик: атомарные обновления распределены по нескольким
+// счётчикам на разных кэш-линиях (поток t пишет в шард t % shards), что
+// снижает конкуренцию за одну линию при сохранении атомарности обновлений
+const int counter_shards = 8;
+
+template <typename Sum>
+Sum reduction_sharded(const vector<int>& vec, int num_threads, int work) {
+    vector<PaddedSlot<Sum>> shards(counter_shards);
+
+    #pragma omp parallel num_threads(num_threads) if(num_threads > 1)
+    {
+        Sum& shard = shards[omp_get_thread_num() % counter_shards].value;
+
+        #pragma omp for
+        for (size_t i = 0; i < vec.size(); ++i) {
+            int value = local_work(vec[i], work);
+            #pragma omp atomic
+            shard += value;
+        }
+    }
+
+    Sum sum = 0;
+    for (const PaddedSlot<Sum>& shard : shards) {
+        sum += shard.value;
+    }
+    return sum;
+}
+
+// Локальное накопление в потоке и одно атомарное сложение в общую сумму в конце
+template <typename Sum>
+Sum reduction_local_flush(const vector<int>& vec, int num_threads, int work) {
+    Sum sum = 0;
+
+    #pragma omp parallel num_threads(num_threads) if(num_threads > 1)
+    {
+        Sum local_sum = 0;
+
+        #pragma omp for
+        for (size_t i = 0; i < vec.size(); ++i) {
+            local_sum += local_work(vec[i], work);
+        }
+
+        #pragma omp atomic
+        sum += local_sum;
+    }
+    return sum;
+}
+
+// Суммирование в общий double циклом compare-and-swap
+// (для чисел с плавающей точкой нет аппаратного атомарного сложения).
+// Целые суммы до 2^53 представимы в double точно, поэтому результат сверяется
+// с эталоном так же, как у целочисленных вариантов
+template <typename Sum>
+Sum reduction_cas_double(const vector<int>& vec, int num_threads, int work) {
+    atomic<double> sum(0.0);
 
-    std::cout << "Method | Number of Threads | Vector Size | Time (seconds)\n";
+    #pragma omp parallel for num_threads(num_threads) if(num_threads > 1)
+    for (size_t i = 0; i < vec.size(); ++i) {
+        double value = local_work(vec[i], work);
+        double expected = sum.load(memory_order_relaxed);
+        while (!sum.compare_exchange_weak(expected, expected + value, memory_order_relaxed)) {
+        }
+    }
+    return static_cast<Sum>(sum.load());
+}
+
+// Частичные суммы потоков в общем массиве с шагом stride байт - частый
+// "ручной" приём partial[tid] += x. При stride < 64 счётчики соседних потоков
+// делят кэш-линию (ложное разделение), при stride >= 64 у каждого потока своя
+// линия. Обращение через volatile сохраняет запись в память на каждой итерации,
+// как в коде, где компилятор не может держать счётчик в регистре.
+// Если counts не нулевой, каждый поток снимает аппаратные счётчики events на
+// время цикла, а их сумма по потокам записывается в counts
+void reduction_strided_slots(const vector<int>& vec, int num_threads, size_t stride,
+                             const vector<PerfEventSpec>& events, vector<long long>* counts) {
+    omp_set_num_threads(num_threads);
+    vector<PaddedSlot<int>> storage(num_threads * stride / sizeof(PaddedSlot<int>) + 1);
+    char* slots = reinterpret_cast<char*>(storage.data());
+    if (counts) counts->assign(events.size(), 0);
+
+    #pragma omp parallel
+    {
+        volatile int* slot = reinterpret_cast<int*>(slots + omp_get_thread_num() * stride);
+        PerfCounters perf(counts ? events : vector<PerfEventSpec>());
+        perf.start();
+
+        #pragma omp for
+        for (size_t i = 0; i < vec.size(); ++i) {
+            *slot += vec[i];
+        }
+
+        perf.stop();
+        if (counts) {
+            #pragma omp critical
+            for (size_t k = 0; k < perf.size(); ++k) {
+                long long value = perf.value(k);
+                if (value < 0 || (*counts)[k] < 0) (*counts)[k] = -1;
+                else (*counts)[k] += value;
+            }
+        }
+    }
+
+    int sum = 0;
+    for (int t = 0; t < num_threads; ++t) {
+        sum += *reinterpret_cast<int*>(slots + t * stride);
+    }
+    do_not_optimize(sum);
+}
+
+// Режим --mode=false-sharing: пропускная способность и аппаратные счётчики
+// для разных шагов между счётчиками потоков (--strides=4,8,...,128 байт).
+// Шаг должен быть положительным и кратным sizeof(int), иначе обращение к
+// счётчику невыровнено; при недопустимом шаге возвращает false
+bool run_false_sharing(int argc, char* argv[], BenchmarkRunner& runner, const vector<int>& thread_counts) {
+    const vector<int> strides = parse_int_list(get_option(argc, argv, "strides", "4,8,16,32,64,128"));
+    const int vector_size = stoi(get_option(argc, argv, "size", "10000000"));
+    const vector<PerfEventSpec> events = cache_contention_events(get_option(argc, argv, "hitm-event", ""));
+
+    for (int stride : strides) {
+        if (stride <= 0 || stride % sizeof(int) != 0) {
+            cerr << "Invalid stride: " << stride << " (must be a positive multiple of " << sizeof(int) << " bytes)" << endl;
+            return false;
+        }
+    }
+
+    vector<int> vec(vector_size);
+    initialize_vector(vec);
+
+    cout << "Stride (B) | Threads | Median Time (s) | Throughput (Melem/s)";
+    for (const PerfEventSpec& event : events) cout << " | " << event.name << " per 1k";
+    cout << "\n--------------------------------------------------------------------------------------\n";
+
+    for (int num_threads : thread_counts) {
+        for (int stride : strides) {
+            BenchmarkParams params = {{"size", to_string(vector_size)}, {"threads", to_string(num_threads)},
+                                      {"stride", to_string(stride)}};
+
+            double time = runner.run("reduction_strided_slots", params, [&]() {
+                reduction_strided_slots(vec, num_threads, stride, events, nullptr);
+            }).median;
+
+            // Отдельный прогон со снятием счётчиков, чтобы их открытие не попадало в замер времени
+            vector<long long> counts;
+            reduction_strided_slots(vec, num_threads, stride, events, &counts);
+
+            cout << fixed << setprecision(6) << setw(10) << stride << " | " << setw(7) << num_threads << " | "
+                 << setw(15) << time << " | " << setw(20) << setprecision(1) << vector_size / time / 1e6;
+            for (long long count : counts) {
+                cout << " | ";
+                if (count < 0) cout << "n/a";
+                else cout << setprecision(3) << 1000.0 * count / vector_size;
+            }
+            cout << "\n";
+        }
+        cout << "--------------------------------------------------------------------------------------\n";
+    }
+    return true;
+}
+
+template <typename Sum>
+struct ReductionStrategy {
+    const char* label;
+    const char* kernel;
+    Sum (*function)(const vector<int>&, int, int);
+};
+
+// Набор вариантов суммирования с проверкой результата. Каждый замер сверяется
+// с последовательным эталоном; результат передаётся в do_not_optimize, так что
+// компилятор не может выбросить вычисление. Возвращает число несовпадений
+template <typename Sum>
+int run_reduction_suite(int argc, char* argv[], BenchmarkRunner& runner, const vector<int>& vector_sizes,
+                        const vector<int>& thread_counts, const vector<int>& work_units, const string& accumulator) {
+    const vector<ReductionStrategy<Sum>> strategies = {
+        {"Atomic Operation      ", "reduction_atomic", reduction_atomic<Sum>},
+        {"Critical Section      ", "reduction_critical", reduction_critical<Sum>},
+        {"Lock                  ", "reduction_lock", reduction_lock<Sum>},
+        {"Built-in Reduction    ", "reduction_builtin", reduction_builtin<Sum>},
+        {"Padded Slots          ", "reduction_padded_slots", reduction_padded_slots<Sum>},
+        {"Sharded Counter       ", "reduction_sharded", reduction_sharded<Sum>},
+        {"Local + Atomic Flush  ", "reduction_local_flush", reduction_local_flush<Sum>},
+        {"CAS Loop (double)     ", "reduction_cas_double", reduction_cas_double<Sum>},
+    };
+    int failures = 0;
+
+    // Одна политика на весь набор: варианты сравниваются между собой, поэтому
+    // в строке с одними size, work и threads все они работают на одной и той
+    // же команде. Порог - по встроенной редукции без локальной работы на
+    // одном потоке. Единица work по стоимости близка к элементу, поэтому
+    // объём задачи оценивается как size * (1 + work)
+    vector<int> sample(1 << 16);
+    initialize_vector(sample);
+    int max_threads = *max_element(thread_counts.begin(), thread_counts.end());
+    ExecutionPolicy policy = make_execution_policy(argc, argv, "reduction_suite", max_threads, sample.size(), [&]() {
+        do_not_optimize(reduction_builtin<Sum>(sample, 1, 0));
+    });
+    print_execution_policy(policy);
+
+    std::cout << "Method | Number of Threads | Effective Threads | Vector Size | Local Work | Median Time (seconds) | Sum | Check\n";
     cout << "--------------------------------------------------------------\n";
 
     // Основной цикл по размерам вектора
     for (int vector_size : vector_sizes) {
         vector<int> vec(vector_size);
         initialize_vector(vec);
+        const long long expected = reduction_serial(vec);
 
-        for (int num_threads : thread_counts) {
-            double time_atomic = reduction_atomic(vec, num_threads);
-            double time_critical = reduction_critical(vec, num_threads);
-            double time_lock = reduction_lock(vec, num_threads);
-            double time_builtin = reduction_builtin(vec, num_threads);
-
-            cout << fixed << setprecision(6);
-            cout << "Atomic Operation      | " << num_threads << "           | " << vector_size << "       | " << time_atomic << "\n";
-            cout << "Critical Section      | " << num_threads << "           | " << vector_size << "       | " << time_critical << "\n";
-            cout << "Lock                  | " << num_threads << "           | " << vector_size << "       | " << time_lock << "\n";
-            cout << "Built-in Reduction    | " << num_threads << "           | " << vector_size << "       | " << time_builtin << "\n";
-            cout << "--------------------------------------------------------------\n";
+        for (int work : work_units) {
+            for (int num_threads : thread_counts) {
+                int threads = policy.threads_for(vec.size() * (1 + work), num_threads);
+                BenchmarkParams params = {{"size", to_string(vector_size)}, {"threads", to_string(num_threads)},
+                                          {"effective_threads", to_string(threads)},
+                                          {"work", to_string(work)}, {"accumulator", accumulator}};
+
+                cout << fixed << setprecision(6);
+                for (const ReductionStrategy<Sum>& strategy : strategies) {
+                    Sum sum = 0;
+                    bool correct = true;
+                    double time = runner.run(strategy.kernel, params, [&]() {
+                        sum = strategy.function(vec, threads, work);
+                        do_not_optimize(sum);
+                        correct = correct && static_cast<long long>(sum) == expected;
+                    }).median;
+                    if (!correct) ++failures;
+                    cout << strategy.label << "| " << num_threads << "           | " << threads << "           | "
+                         << vector_size << "       | "
+                         << work << "          | " << time << " | " << sum << " | "
+                         << (correct ? "OK" : "MISMATCH (expected " + to_string(expected) + ")") << "\n";
+                }
+                cout << "--------------------------------------------------------------\n";
+            }
         }
     }
 
+    return failures;
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkRunner runner("openmp7", parse_benchmark_options(argc, argv));
+    data_seed = parse_data_seed(argc, argv);
+
+    const vector<int> thread_counts = {2, 4, 8, 16};
+    const vector<int> vector_sizes = parse_int_list(get_option(argc, argv, "sizes", "10000,100000,1000000,10000000"));
+    // --work=0,16,256: единиц локальной работы на одно обновление общей суммы
+    const vector<int> work_units = parse_int_list(get_option(argc, argv, "work", "0"));
+    // --accumulator=int32 - исходный int-накопитель (при значениях 0..99 переполняется примерно с 4*10^7 элементов)
+    const string accumulator = get_option(argc, argv, "accumulator", "int64");
+
+    // --mode=false-sharing: частичные суммы потоков с разным шагом в общем массиве
+    if (get_option(argc, argv, "mode", "default") == "false-sharing") {
+        return run_false_sharing(argc, argv, runner, thread_counts) ? 0 : 1;
+    }
+
+    int failures = accumulator == "int32"
+        ? run_reduction_suite<int>(argc, argv, runner, vector_sizes, thread_counts, work_units, accumulator)
+        : run_reduction_suite<long long>(argc, argv, runner, vector_sizes, thread_counts, work_units, "int64");
+
+    if (failures > 0) {
+        cerr << failures << " reduction result(s) did not match the serial reference\n";
+        return 1;
+    }
     return 0;
 }
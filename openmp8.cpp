@@ -2,99 +2,212 @@
 #include <fstream>
 #include <vector>
 #include <cstdlib>
-#include <chrono>
 #include <omp.h>
 #include <mutex>
 #include <condition_variable>
+#include <memory>
+#include <algorithm>
+#include <thread>
+#include <cstdint>
+#include <filesystem>
+#include <system_error>
+#include "benchmark.h"
+#include "spsc_ring.h"
+#include "vector_file.h"
+#include "data_generator.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
 
 using namespace std;
 
-vector<int> buffer1_1, buffer2_1;
-vector<int> buffer1_2, buffer2_2;
+// Пары векторов двойной буферизации: указатели на векторы, nullptr - буфер пуст.
+// Текстовый вход копируется в storage*, двоичный передаётся указателями прямо
+// на страницы отображённого файла
+const int* buffer1_1 = nullptr;
+const int* buffer2_1 = nullptr;
+const int* buffer1_2 = nullptr;
+const int* buffer2_2 = nullptr;
+vector<int> storage1_1, storage2_1;
+vector<int> storage1_2, storage2_2;
 bool useFirstBuffer = true;
 mutex mtx;  // Мьютекс для синхронизации потоков
 condition_variable cv;
 bool done = false;
+double handoffTime = 0.0;  // Момент передачи последней пары потребителю
+vector<double> handoffLatencies;  // Задержки от передачи пары до начала её обработки
+bool useFastParser = false;  // --parser=fast: блочный параллельный разбор через from_chars
+int parserThreads = 1;       // --parser-threads=N: потоков разбора (вне параллельной области)
+uint64_t dataSeed = 1;       // --seed=N: зерно генерируемых векторов
+bool regenerateData = false; // --regenerate=1: создавать файлы заново, даже если они уже есть
 
-// Генерация случайных векторов и запись их в файл
-void generateAndWriteVectors(const string& filename, int n, int dim) {
-    ofstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Failed to open file for writing!" << endl;
-        return;
+// Генерация случайных векторов и запись их в файл. Элементы от 0 до 9 задаются
+// счётчиковым генератором из (dataSeed, номер элемента), строки форматируются
+// параллельно; содержимое файла не зависит от числа потоков
+bool generateAndWriteVectors(const string& filename, int n, int dim) {
+    return write_text_vectors_parallel(filename, n, dim, [](uint64_t k) { return counter_int(dataSeed, k, 0, 9); });
+}
+
+// Файл пишется под временным именем и переносится на место переименованием
+// только после успешной записи: прерванная генерация не оставит под
+// постоянным именем усечённый файл, который переиспользуют следующие запуски
+template <typename Write>
+bool writeFileAtomically(const string& filename, Write&& write) {
+    string temporary = filename + ".tmp";
+    error_code error;
+    if (!write(temporary)) {
+        filesystem::remove(temporary, error);
+        return false;
+    }
+    filesystem::rename(temporary, filename, error);
+    if (error) {
+        cerr << "Failed to rename " << temporary << " to " << filename << ": " << error.message() << endl;
+        filesystem::remove(temporary, error);
+        return false;
     }
+    return true;
+}
 
-    srand(time(0));
+// Файл с n векторами длины dim: имя определяется параметрами и зерном, поэтому
+// уже созданный файл (в том числе в прошлых запусках) переиспользуется для всех
+// чисел потоков и режимов вместо повторной генерации. Переиспользуется только
+// файл ожидаемого размера: каждый элемент - цифра и пробел, в конце строки
+// перевод строки, то есть n * (2 * dim + 1) байт
+string vectorFileFor(int n, int dim) {
+    string filename = "vectors_" + to_string(n) + "x" + to_string(dim) + "_seed" + to_string(dataSeed) + ".txt";
+    error_code error;
+    uintmax_t expectedSize = static_cast<uintmax_t>(n) * (2 * static_cast<uintmax_t>(dim) + 1);
+    uintmax_t size = filesystem::file_size(filename, error);
+    if (regenerateData || error || size != expectedSize) {
+        writeFileAtomically(filename, [&](const string& temporary) {
+            return generateAndWriteVectors(temporary, n, dim);
+        });
+    }
+    return filename;
+}
 
-    for (int i = 0; i < n; ++i) {
-        for (int j = 0; j < dim; ++j) {
-            int element = rand() % 10;
-            file << element << " ";
-        }
-        file << endl;
+// Двоичная копия файла vectorFileFor(n, dim) для отображения в память.
+// Переиспользуется, если заголовок описывает ровно n векторов длины dim;
+// пустая строка - файл создать не удалось
+string binaryVectorFileFor(int n, int dim) {
+    string filename = vectorFileFor(n, dim);
+    string binaryFilename = filename + ".bin";
+    MappedVectorFile cached;
+    bool valid = !regenerateData && filesystem::exists(binaryFilename) && cached.open(binaryFilename) &&
+                 cached.count() == static_cast<size_t>(n) && cached.dim() == static_cast<size_t>(dim);
+    cached.close();
+    if (!valid && !writeFileAtomically(binaryFilename, [&](const string& temporary) {
+            return convert_text_to_binary(filename, temporary, dim);
+        })) {
+        return "";
     }
+    return binaryFilename;
+}
 
-    file.close();
+// Открытие двоичного файла векторов длины dim для конвейеров
+bool openMappedInput(MappedVectorFile& mapped, const string& filename, int dim) {
+    if (!mapped.open(filename)) {
+        return false;
+    }
+    if (mapped.dim() != static_cast<size_t>(dim)) {
+        cerr << "Vector file has dimension " << mapped.dim() << ", expected " << dim << endl;
+        mapped.close();
+        return false;
+    }
+    return true;
 }
 
-// Чтение пар векторов из файла и сохранение в буферы
-void readVectorsPairwise(const string& filename, int dim) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Failed to open file!" << endl;
-        done = true;
-        return;
+// Вектор для буфера: данные, которые живут дольше обработки пары (страницы
+// отображения), передаются указателем, остальные копируются в storage
+const int* holdVector(vector<int>& storage, const int* vectorData, int dim, bool stable) {
+    if (stable) {
+        return vectorData;
     }
+    storage.assign(vectorData, vectorData + dim);
+    return storage.data();
+}
 
-    int element;
+// Чтение пар векторов из файла и сохранение в буферы. Если задан mapped
+// (--format=binary), векторы передаются указателями на его страницы
+void readVectorsPairwise(const string& filename, int dim, const MappedVectorFile* mapped = nullptr) {
     int vectorCount = 0;
-    vector<int> currentVector;
-    currentVector.reserve(dim);
-
-    while (file >> element) {
-        currentVector.push_back(element);
 
-        // Если вектор заполнен, добавляем его в буфер
-        if (currentVector.size() == dim) {
-            vectorCount++;
-            unique_lock<mutex> lock(mtx);
+    // Передача очередного вектора в буфер; после второго вектора пары
+    // переключаем буфер и ждём завершения обработки
+    auto publish = [&](const int* vectorData, bool stable) {
+        vectorCount++;
+        unique_lock<mutex> lock(mtx);
 
-            if (vectorCount % 2 == 1) {
-                if (useFirstBuffer) {
-                    buffer1_1 = currentVector;
-                } else {
-                    buffer1_2 = currentVector;
-                }
+        if (vectorCount % 2 == 1) {
+            if (useFirstBuffer) {
+                buffer1_1 = holdVector(storage1_1, vectorData, dim, stable);
             } else {
-                if (useFirstBuffer) {
-                    buffer2_1 = currentVector;
-                } else {
-                    buffer2_2 = currentVector;
-                }
-                
-                useFirstBuffer = !useFirstBuffer; // Переключаем буфер
-                cv.notify_one(); // Уведомляем другой поток
-                cv.wait(lock);   // Ждём завершения обработки
+                buffer1_2 = holdVector(storage1_2, vectorData, dim, stable);
+            }
+        } else {
+            if (useFirstBuffer) {
+                buffer2_1 = holdVector(storage2_1, vectorData, dim, stable);
+            } else {
+                buffer2_2 = holdVector(storage2_2, vectorData, dim, stable);
+            }
+
+            useFirstBuffer = !useFirstBuffer; // Переключаем буфер
+            handoffTime = omp_get_wtime();
+            cv.notify_one(); // Уведомляем другой поток
+            cv.wait(lock);   // Ждём завершения обработки
+        }
+    };
+
+    if (mapped) {
+        for (size_t v = 0; v < mapped->count(); ++v) {
+            publish(mapped->vector(v), true);
+        }
+    } else if (useFastParser) {
+        read_text_vectors_parallel(filename, dim, parserThreads, [&](const int* data, size_t vectors) {
+            for (size_t v = 0; v < vectors; ++v) {
+                publish(data + v * dim, false);
+            }
+        });
+    } else {
+        ifstream file(filename);
+        if (!file.is_open()) {
+            cerr << "Failed to open file!" << endl;
+            done = true;
+            return;
+        }
+
+        int element;
+        vector<int> currentVector;
+        currentVector.reserve(dim);
+
+        while (file >> element) {
+            currentVector.push_back(element);
+
+            // Если вектор заполнен, добавляем его в буфер
+            if (static_cast<int>(currentVector.size()) == dim) {
+                publish(currentVector.data(), false);
+                currentVector.clear();
             }
-            currentVector.clear();
         }
     }
 
+    lock_guard<mutex> lock(mtx);
     done = true;
     cv.notify_one();  // Уведомляем другой поток о завершении
-    file.close();
 }
 
 // Вычисление скалярного произведения пар векторов
 void calculateDotProduct(int dim, vector<int>& results) {
     while (true) {
         unique_lock<mutex> lock(mtx);
-        cv.wait(lock, [] { return (done || (!buffer1_1.empty() && !buffer2_1.empty()) || (!buffer1_2.empty() && !buffer2_2.empty())); });
+        cv.wait(lock, [] { return (done || (buffer1_1 && buffer2_1) || (buffer1_2 && buffer2_2)); });
 
         // Проверяем, если завершено чтение и буферы пусты
-        if (done && (buffer1_1.empty() || buffer2_1.empty()) && (buffer1_2.empty() || buffer2_2.empty())) {
+        if (done && (!buffer1_1 || !buffer2_1) && (!buffer1_2 || !buffer2_2)) {
             break;
         }
+        handoffLatencies.push_back(omp_get_wtime() - handoffTime);
 
         int partialSum = 0;
         if (useFirstBuffer) {
@@ -102,36 +215,259 @@ void calculateDotProduct(int dim, vector<int>& results) {
                 partialSum += buffer1_2[i] * buffer2_2[i];
             }
             results.push_back(partialSum);  // Добавляем результат
-            buffer1_2.clear();
-            buffer2_2.clear();
+            buffer1_2 = nullptr;
+            buffer2_2 = nullptr;
         } else {
             for (int i = 0; i < dim; ++i) {
                 partialSum += buffer1_1[i] * buffer2_1[i];
             }
             results.push_back(partialSum);  // Добавляем результат
-            buffer1_1.clear();
-            buffer2_1.clear();
+            buffer1_1 = nullptr;
+            buffer2_1 = nullptr;
         }
 
         cv.notify_one();  // Уведомляем другой поток
     }
 }
 
+// Скалярное произведение пары; omp simd векторизует цикл с редукцией
+// (для больших dim это основная часть работы вычислителя)
+inline int dotProductSimd(const int* first, const int* second, int dim) {
+    int sum = 0;
+    #pragma omp simd reduction(+:sum)
+    for (int i = 0; i < dim; ++i) {
+        sum += first[i] * second[i];
+    }
+    return sum;
+}
+
+// Ячейка кольца: пара векторов, её порядковый номер во входном файле и момент
+// публикации для измерения задержки передачи. firstData/secondData указывают
+// на пару: на векторы first/second, которые читатель текста заполняет на
+// месте, или прямо на страницы отображённого двоичного файла
+struct VectorPairSlot {
+    vector<int> first;
+    vector<int> second;
+    const int* firstData = nullptr;
+    const int* secondData = nullptr;
+    long long sequence = 0;
+    double publishedAt = 0.0;
+};
+
+// Результат пары с её порядковым номером: вычислители обрабатывают пары
+// в произвольном порядке, а итог восстанавливается по номерам
+struct SequencedResult {
+    long long sequence;
+    int value;
+};
+
+// Чтение пар векторов прямо в ячейки колец: пара номер k попадает в кольцо
+// k % rings.size(). Читатель может опережать каждого вычислителя на depth пар,
+// не дожидаясь обработки каждой. afterCommit(r) вызывается после публикации
+// пары в кольцо r. Если задан mapped, в ячейки пишутся только указатели на
+// его страницы, без разбора и копирования
+template <typename AfterCommit>
+void readVectorsToRings(const string& filename, int dim, const vector<SpscRing<VectorPairSlot>*>& rings,
+                        const MappedVectorFile* mapped, AfterCommit&& afterCommit) {
+    if (mapped) {
+        long long pairs = static_cast<long long>(mapped->count() / 2);
+        for (long long sequence = 0; sequence < pairs; ++sequence) {
+            size_t ringIndex = sequence % rings.size();
+            SpscRing<VectorPairSlot>& ring = *rings[ringIndex];
+            VectorPairSlot& slot = ring.acquire_write();
+            slot.firstData = mapped->vector(2 * sequence);
+            slot.secondData = mapped->vector(2 * sequence + 1);
+            slot.sequence = sequence;
+            slot.publishedAt = omp_get_wtime();
+            ring.commit_write();
+            afterCommit(ringIndex);
+        }
+        for (SpscRing<VectorPairSlot>* ring : rings) ring->close();
+        return;
+    }
+
+    ifstream file(filename);
+    if (!file.is_open()) {
+        cerr << "Failed to open file!" << endl;
+        for (SpscRing<VectorPairSlot>* ring : rings) ring->close();
+        return;
+    }
+
+    for (long long sequence = 0;; ++sequence) {
+        size_t ringIndex = sequence % rings.size();
+        SpscRing<VectorPairSlot>& ring = *rings[ringIndex];
+        VectorPairSlot& slot = ring.acquire_write();
+        bool complete = true;
+        for (int j = 0; j < dim && complete; ++j) {
+            complete = static_cast<bool>(file >> slot.first[j]);
+        }
+        for (int j = 0; j < dim && complete; ++j) {
+            complete = static_cast<bool>(file >> slot.second[j]);
+        }
+        if (!complete) {
+            break;
+        }
+
+        slot.firstData = slot.first.data();
+        slot.secondData = slot.second.data();
+        slot.sequence = sequence;
+        slot.publishedAt = omp_get_wtime();
+        ring.commit_write();
+        afterCommit(ringIndex);
+    }
+
+    for (SpscRing<VectorPairSlot>* ring : rings) ring->close();
+}
+
+void readVectorsToRings(const string& filename, int dim, const vector<SpscRing<VectorPairSlot>*>& rings,
+                        const MappedVectorFile* mapped = nullptr) {
+    readVectorsToRings(filename, dim, rings, mapped, [](size_t) {});
+}
+
+// Вычисление скалярных произведений пар из кольца
+void calculateDotProductFromRing(int dim, SpscRing<VectorPairSlot>& ring, vector<SequencedResult>& results,
+                                 vector<double>& latencies) {
+    while (VectorPairSlot* slot = ring.acquire_read()) {
+        latencies.push_back(omp_get_wtime() - slot->publishedAt);
+        results.push_back({slot->sequence, dotProductSimd(slot->firstData, slot->secondData, dim)});
+        ring.release_read();
+    }
+}
+
+// Обработка одной готовой пары из кольца, если она есть (без ожидания)
+bool tryDotProductFromRing(int dim, SpscRing<VectorPairSlot>& ring, vector<SequencedResult>& results,
+                           vector<double>& latencies) {
+    VectorPairSlot* slot = ring.try_acquire_read();
+    if (slot == nullptr) {
+        return false;
+    }
+    latencies.push_back(omp_get_wtime() - slot->publishedAt);
+    results.push_back({slot->sequence, dotProductSimd(slot->firstData, slot->secondData, dim)});
+    ring.release_read();
+    return true;
+}
+
+// Вычислитель с кольцами first, first + stride, ...: опрашивает их по очереди
+// без ожидания, пока все они не закроются и не опустеют. У каждого кольца
+// по-прежнему один читатель, а результаты и задержки хранятся по кольцам
+void drainRings(int dim, const vector<unique_ptr<SpscRing<VectorPairSlot>>>& rings, size_t first, size_t stride,
+                vector<vector<SequencedResult>>& partial, vector<vector<double>>& latencies) {
+    while (true) {
+        bool active = false;
+        bool progressed = false;
+        for (size_t r = first; r < rings.size(); r += stride) {
+            if (tryDotProductFromRing(dim, *rings[r], partial[r], latencies[r])) {
+                progressed = true;
+                active = true;
+            } else if (!rings[r]->drained()) {
+                active = true;
+            }
+        }
+        if (!active) {
+            break;
+        }
+        if (!progressed) {
+            this_thread::yield();
+        }
+    }
+}
+
+// Сборка результатов всех вычислителей в порядке входного файла
+void collectInOrder(const vector<vector<SequencedResult>>& partial, vector<int>& results) {
+    size_t total = 0;
+    for (const vector<SequencedResult>& part : partial) total += part.size();
+    results.assign(total, 0);
+    for (const vector<SequencedResult>& part : partial) {
+        for (const SequencedResult& result : part) {
+            results[result.sequence] = result.value;
+        }
+    }
+}
+
+// Конвейер "один читатель - вычислители": поток 0 читает файл в rings.size()
+// колец глубины depth, остальные потоки команды считают пары. Команда может
+// оказаться меньше запрошенных rings.size() + 1 потоков (OMP_THREAD_LIMIT,
+// OMP_DYNAMIC, вложенность), поэтому кольца распределяются по фактическому
+// размеру команды: вычислитель w (из team - 1) опрашивает кольца w,
+// w + (team - 1), ... Команда из одного потока считает каждую пару сразу
+// после её чтения. Возвращает число потоков-вычислителей (0 - без них).
+// mapped - двоичный вход вместо текстового файла (см. readVectorsToRings)
+int runWorkerPipeline(const string& filename, int dim, const vector<unique_ptr<SpscRing<VectorPairSlot>>>& rings,
+                      vector<int>& results, vector<double>& latencies, const MappedVectorFile* mapped = nullptr) {
+    int workers = static_cast<int>(rings.size());
+    vector<SpscRing<VectorPairSlot>*> ringPointers;
+    for (const unique_ptr<SpscRing<VectorPairSlot>>& ring : rings) {
+        ring->reset();
+        ringPointers.push_back(ring.get());
+    }
+    vector<vector<SequencedResult>> partial(workers);
+    vector<vector<double>> ringLatencies(workers);
+    int teamWorkers = 0;
+
+    #pragma omp parallel num_threads(workers + 1)
+    {
+        int id = omp_get_thread_num();
+        int team = omp_get_num_threads();
+        if (id == 0) {
+            teamWorkers = team - 1;
+            if (team == 1) {
+                readVectorsToRings(filename, dim, ringPointers, mapped, [&](size_t r) {
+                    tryDotProductFromRing(dim, *rings[r], partial[r], ringLatencies[r]);
+                });
+            } else {
+                readVectorsToRings(filename, dim, ringPointers, mapped);
+            }
+        } else if (id <= workers) {
+            drainRings(dim, rings, id - 1, team - 1, partial, ringLatencies);
+        }
+    }
+
+    collectInOrder(partial, results);
+    latencies.clear();
+    for (const vector<double>& part : ringLatencies) {
+        latencies.insert(latencies.end(), part.begin(), part.end());
+    }
+    return teamWorkers;
+}
+
 // Последовательное вычисление скалярного произведения для проверки
 void calculateDotProductSequential(const string& filename, int dim, int n, vector<int>& results) {
-    ifstream file(filename);
     vector<int> vec1(dim), vec2(dim);
-    int element;
-    
+
+    if (useFastParser) {
+        // Первый вектор пары может оказаться в конце одного блока, а второй - в начале следующего
+        bool haveFirst = false;
+        read_text_vectors_parallel(filename, dim, parserThreads, [&](const int* data, size_t vectors) {
+            for (size_t v = 0; v < vectors && static_cast<int>(results.size()) < n / 2; ++v) {
+                const int* current = data + v * dim;
+                if (!haveFirst) {
+                    copy(current, current + dim, vec1.begin());
+                    haveFirst = true;
+                    continue;
+                }
+
+                int dotProduct = 0;
+                for (int j = 0; j < dim; ++j) {
+                    dotProduct += vec1[j] * current[j];
+                }
+                results.push_back(dotProduct);
+                haveFirst = false;
+            }
+        });
+        return;
+    }
+
+    ifstream file(filename);
+
     for (int i = 0; i < n / 2; ++i) {
         for (int j = 0; j < dim; ++j) {
             file >> vec1[j];
         }
-        
+
         for (int j = 0; j < dim; ++j) {
             file >> vec2[j];
         }
-        
+
         int dotProduct = 0;
         for (int j = 0; j < dim; ++j) {
             dotProduct += vec1[j] * vec2[j];
@@ -141,56 +477,435 @@ void calculateDotProductSequential(const string& filename, int dim, int n, vecto
     file.close();
 }
 
-int main() {
-    string filename = "vectors.txt";
+// Разбор всего текстового файла в память (без вычислений)
+void readAllVectorsText(const string& filename, vector<int>& data) {
+    ifstream file(filename);
+    data.clear();
+    int element;
+    while (file >> element) {
+        data.push_back(element);
+    }
+}
+
+// Скалярные произведения пар, лежащих в памяти подряд (vectors[2k], vectors[2k + 1]):
+// и для разобранного текста, и прямо для страниц отображённого файла
+void dotProductsFromMemory(const int* vectors, int dim, int pairs, int threads, vector<int>& results) {
+    results.assign(pairs, 0);
+    #pragma omp parallel for num_threads(threads) schedule(static)
+    for (int k = 0; k < pairs; ++k) {
+        const int* first = vectors + static_cast<size_t>(2 * k) * dim;
+        results[k] = dotProductSimd(first, first + dim, dim);
+    }
+}
+
+// Режим --mode=formats: время разбора/отображения файла и время вычислений
+// отдельно для текстового и двоичного (mmap) форматов
+void compareFileFormats(BenchmarkRunner& runner, const vector<int>& vector_counts,
+                        const vector<int>& matrix_sizes, const vector<int>& thread_counts) {
+    cout << "Number of vectors | Vector size | Threads | Text parse (sec) | Fast parse (sec) | Fast parse (GB/s) | "
+         << "Text compute (sec) | Binary map (sec) | Binary compute (sec) | Result\n";
+
+    for (int n : vector_counts) {
+        for (int dim : matrix_sizes) {
+            string filename = vectorFileFor(n, dim);
+            string binaryFilename = binaryVectorFileFor(n, dim);
+            if (binaryFilename.empty()) {
+                return;
+            }
+
+            vector<int> sequentialResults;
+            calculateDotProductSequential(filename, dim, n, sequentialResults);
+
+            for (int threads : thread_counts) {
+                BenchmarkParams params = {{"vectors", to_string(n)}, {"dim", to_string(dim)}, {"threads", to_string(threads)}};
+                vector<int> textData;
+                vector<int> fastData;
+                vector<int> textResults;
+                vector<int> binaryResults;
+                MappedVectorFile mapped;
+
+                double textParse = runner.run("text_parse", params, [&]() {
+                    readAllVectorsText(filename, textData);
+                }).median;
+                double fastParse = runner.run("text_parse_fast", params, [&]() {
+                    fastData.clear();
+                    read_text_vectors_parallel(filename, dim, threads, [&](const int* data, size_t vectors) {
+                        fastData.insert(fastData.end(), data, data + vectors * dim);
+                    });
+                }).median;
+                double textCompute = runner.run("text_compute", params, [&]() {
+                    dotProductsFromMemory(textData.data(), dim, n / 2, threads, textResults);
+                }).median;
+                double binaryMap = runner.run("binary_map", params, [&]() {
+                    mapped.open(binaryFilename);
+                }).median;
+                // После прогрева страницы файла уже подкачаны, поэтому медиана -
+                // вычисления по тёплому отображению; подкачка файла сюда не входит
+                double binaryCompute = runner.run("binary_compute", params, [&]() {
+                    dotProductsFromMemory(mapped.vector(0), dim, static_cast<int>(mapped.count() / 2), threads,
+                                          binaryResults);
+                }).median;
+
+                double textBytes = static_cast<double>(ifstream(filename, ios::binary | ios::ate).tellg());
+                cout << n << " | " << dim << " | " << threads << " | " << textParse << " | " << fastParse << " | "
+                     << textBytes / fastParse / 1e9 << " | " << textCompute << " | "
+                     << binaryMap << " | " << binaryCompute << " | ";
+                if (textResults == sequentialResults && binaryResults == sequentialResults && fastData == textData) {
+                    cout << "Match\n";
+                } else {
+                    cout << "Do not match\n";
+                }
+            }
+        }
+    }
+}
+
+// Блок разобранных векторов в кольце потокового режима; память ячейки
+// переиспользуется, поэтому объём не растёт с размером входного файла
+struct VectorBlockSlot {
+    vector<int> data;
+    size_t vectors = 0;
+};
+
+// Гистограмма скалярных произведений по степеням двойки:
+// корзина k содержит значения из [2^(k-1), 2^k), корзина 0 - нули
+struct DotProductHistogram {
+    uint64_t buckets[33] = {};
+    uint64_t count = 0;
+    long long minimum = 0;
+    long long maximum = 0;
+
+    void add(int value) {
+        unsigned magnitude = static_cast<unsigned>(value < 0 ? -static_cast<long long>(value) : value);
+        int bucket = 0;
+        while (magnitude > 0) {
+            magnitude >>= 1;
+            ++bucket;
+        }
+        ++buckets[bucket];
+        minimum = count == 0 ? value : min<long long>(minimum, value);
+        maximum = count == 0 ? value : max<long long>(maximum, value);
+        ++count;
+    }
+
+    void print() const {
+        cout << "Dot products: " << count << ", min " << minimum << ", max " << maximum << "\n";
+        for (int k = 0; k < 33; ++k) {
+            if (buckets[k] == 0) continue;
+            long long low = k == 0 ? 0 : 1LL << (k - 1);
+            long long high = k == 0 ? 1 : 1LL << k;
+            cout << "  |value| in [" << low << ", " << high << "): " << buckets[k] << "\n";
+        }
+    }
+};
+
+// Пиковый объём резидентной памяти процесса в МБ (0, если неизвестен)
+double peakResidentMegabytes() {
+#if defined(__unix__) || defined(__APPLE__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+    return usage.ru_maxrss / 1024.0;
+#endif
+#else
+    return 0.0;
+#endif
+}
+
+// Режим --mode=stream: обработка файла любого размера в ограниченной памяти.
+// Фоновый поток читает и разбирает файл блоками по blockBytes байт и кладёт
+// их в кольцо глубины readAhead (опережение чтения ограничено); основной поток
+// считает произведения пар блока параллельно и сразу пишет их в outputFile
+// (по одному в строке) или, если файл не задан, добавляет в гистограмму.
+// Память: readAhead + 1 блоков независимо от размера входа.
+// С --format=binary файл отображается в память, блоки считаются прямо по его
+// страницам без разбора и копирования, опережающее чтение делает ядро, а
+// страницы обработанных блоков сразу возвращаются системе
+void streamDotProducts(const string& filename, int dim, int threads, size_t blockBytes, int readAhead,
+                       const string& outputFile, bool binaryInput) {
+    ofstream output;
+    if (!outputFile.empty()) {
+        output.open(outputFile);
+        if (!output.is_open()) {
+            cerr << "Failed to open file for writing!" << endl;
+            return;
+        }
+    }
+
+    vector<int> blockResults;
+    DotProductHistogram histogram;
+    uint64_t pairs = 0;
+    string readAheadInfo;
+
+    // Результаты блока - в файл или в гистограмму
+    auto emitBlock = [&]() {
+        for (int value : blockResults) {
+            if (output.is_open()) {
+                output << value << '\n';
+            } else {
+                histogram.add(value);
+            }
+        }
+        pairs += blockResults.size();
+    };
+
+    double start = omp_get_wtime();
+    if (binaryInput) {
+        MappedVectorFile mapped;
+        if (!openMappedInput(mapped, filename, dim)) {
+            return;
+        }
+        long long totalPairs = static_cast<long long>(mapped.count() / 2);
+        long long pairsPerBlock = max<long long>(1, blockBytes / (2 * dim * sizeof(int)));
+
+        for (long long firstPair = 0; firstPair < totalPairs; firstPair += pairsPerBlock) {
+            int blockPairs = static_cast<int>(min(pairsPerBlock, totalPairs - firstPair));
+            blockResults.resize(blockPairs);
+            #pragma omp parallel for num_threads(threads) schedule(static)
+            for (int k = 0; k < blockPairs; ++k) {
+                size_t v = static_cast<size_t>(2 * (firstPair + k));
+                blockResults[k] = dotProductSimd(mapped.vector(v), mapped.vector(v + 1), dim);
+            }
+            mapped.release(2 * firstPair, 2 * (firstPair + blockPairs));
+            emitBlock();
+        }
+        readAheadInfo = "kernel (mmap)";
+    } else {
+        SpscRing<VectorBlockSlot> ring(max(1, readAhead));
+        thread reader([&]() {
+            read_text_vectors_parallel(filename, dim, parserThreads, [&](const int* data, size_t vectors) {
+                VectorBlockSlot& slot = ring.acquire_write();
+                slot.data.assign(data, data + vectors * dim);
+                slot.vectors = vectors;
+                ring.commit_write();
+            }, blockBytes);
+            ring.close();
+        });
+
+        vector<int> carry(dim);  // Первый вектор пары, если второй попал в следующий блок
+        bool haveCarry = false;
+
+        while (VectorBlockSlot* slot = ring.acquire_read()) {
+            const int* data = slot->data.data();
+            size_t vectors = slot->vectors;
+            blockResults.clear();
+
+            if (haveCarry && vectors > 0) {
+                blockResults.push_back(dotProductSimd(carry.data(), data, dim));
+                data += dim;
+                --vectors;
+                haveCarry = false;
+            }
+
+            int blockPairs = static_cast<int>(vectors / 2);
+            size_t offset = blockResults.size();
+            blockResults.resize(offset + blockPairs);
+            #pragma omp parallel for num_threads(threads) schedule(static)
+            for (int k = 0; k < blockPairs; ++k) {
+                const int* first = data + static_cast<size_t>(2 * k) * dim;
+                blockResults[offset + k] = dotProductSimd(first, first + dim, dim);
+            }
+
+            if (vectors % 2 == 1) {
+                const int* last = data + (vectors - 1) * dim;
+                copy(last, last + dim, carry.begin());
+                haveCarry = true;
+            }
+            ring.release_read();
+            emitBlock();
+        }
+        reader.join();
+        readAheadInfo = to_string(ring.depth()) + " blocks";
+    }
+    double elapsed = omp_get_wtime() - start;
+
+    cout << "Streamed " << pairs << " pairs of dimension " << dim << " in " << elapsed << " s ("
+         << pairs / elapsed << " pairs/sec), block " << blockBytes / (1 << 20) << " MB, read-ahead "
+         << readAheadInfo << ", peak RSS " << peakResidentMegabytes() << " MB\n";
+    if (output.is_open()) {
+        cout << "Results written to " << outputFile << "\n";
+    } else {
+        histogram.print();
+    }
+}
+
+// Строка таблицы: время, пропускная способность (пар в секунду) и медианная
+// задержка передачи пары от читателя к вычислителю
+void print_pipeline_row(int n, int dim, int threads, const string& handoff, const BenchmarkStats& stats,
+                        const vector<double>& latencies, bool match) {
+    double latency = latencies.empty() ? 0.0 : compute_stats(latencies).median;
+    cout << n << " | " << dim << " | " << threads << " | " << handoff << " | ";
+    cout << stats.median << " | " << (n / 2) / stats.median << " | " << latency * 1e6 << " | ";
+    if (match) {
+        cout << "Match\n";
+    } else {
+        cout << "Do not match\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    options.warmup = 1;
+    options.min_repeats = 1;
+    options.min_time = 0.0;
+    BenchmarkRunner runner("openmp8", parse_benchmark_options(argc, argv, options));
+
+    // Конвейер с threads - 1 вычислителями использует кольца глубины --worker-depth=8;
+    // --mode=ring добавляет передачу через одно кольцо глубины --depths=2,8,32
+    string mode = get_option(argc, argv, "mode", "default");
+    // Глубина кольца - целое >= 1
+    vector<int> ring_depths;
+    if (!parse_positive_list(get_option(argc, argv, "depths", "2,8,32"), ring_depths)) {
+        cerr << "Invalid ring depths (expected integers >= 1): " << get_option(argc, argv, "depths", "") << endl;
+        return 1;
+    }
+    size_t worker_depth = 0;
+    if (!parse_positive(get_option(argc, argv, "worker-depth", "8"), worker_depth)) {
+        cerr << "Invalid worker ring depth (expected an integer >= 1): "
+             << get_option(argc, argv, "worker-depth", "") << endl;
+        return 1;
+    }
+    // --parser=fast заменяет разбор через >> в readVectorsPairwise и calculateDotProductSequential
+    useFastParser = get_option(argc, argv, "parser", "stream") == "fast";
+    parserThreads = stoi(get_option(argc, argv, "parser-threads", to_string(omp_get_num_procs())));
+    dataSeed = parse_data_seed(argc, argv);
+    regenerateData = get_option(argc, argv, "regenerate", "0") == "1";
+    // --format=binary: конвейеры и потоковый режим читают двоичную копию файла,
+    // отображённую в память, и считают прямо по её страницам
+    bool binaryInput = get_option(argc, argv, "format", "text") == "binary";
+
     vector<int> vector_counts = {1000, 2000, 3000};
     vector<int> matrix_sizes = {1000, 2000, 3000};
     vector<int> thread_counts = {2,4,8};
 
-    cout << "Number of vectors | Vector size | Threads  | Time (sec) | Result\n";
+    // --mode=stream --input=file --dim=N [--output=file] [--block-mb=16] [--read-ahead=4]:
+    // потоковая обработка файла, не помещающегося в память (с --format=binary
+    // --input - двоичный файл)
+    if (mode == "stream") {
+        int dim = stoi(get_option(argc, argv, "dim", "1000"));
+        string input = get_option(argc, argv, "input", "");
+        if (input.empty()) {
+            int n = stoi(get_option(argc, argv, "vectors", "3000"));
+            input = binaryInput ? binaryVectorFileFor(n, dim) : vectorFileFor(n, dim);
+        }
+        streamDotProducts(input, dim, stoi(get_option(argc, argv, "threads", to_string(omp_get_num_procs()))),
+                          static_cast<size_t>(stoi(get_option(argc, argv, "block-mb", "16"))) << 20,
+                          stoi(get_option(argc, argv, "read-ahead", "4")), get_option(argc, argv, "output", ""),
+                          binaryInput);
+        return 0;
+    }
+
+    // --mode=formats: сравнение текстового файла и двоичного файла, отображённого в память
+    if (mode == "formats") {
+        compareFileFormats(runner, vector_counts, matrix_sizes, thread_counts);
+        return 0;
+    }
+
+    cout << "Number of vectors | Vector size | Threads  | Handoff | Median (sec) | Pairs/sec | Handoff latency p50 (us) | Result\n";
 
     for (int n : vector_counts) {
         for (int dim : matrix_sizes) {
+            // Данные генерируются один раз для всех чисел потоков
+            string filename = vectorFileFor(n, dim);
+            // Двоичный вход отображается один раз; проверка по-прежнему идёт
+            // по текстовому файлу
+            MappedVectorFile mapped;
+            if (binaryInput && !openMappedInput(mapped, binaryVectorFileFor(n, dim), dim)) {
+                return 1;
+            }
+            const MappedVectorFile* input = binaryInput ? &mapped : nullptr;
+
             for (int threads : thread_counts) {
-                done = false;  // Сбрасываем флаг завершения
-                generateAndWriteVectors(filename, n, dim);  // Генерируем данные
 
                 vector<int> parallelResults;
                 vector<int> sequentialResults;
+                BenchmarkParams params = {{"vectors", to_string(n)}, {"dim", to_string(dim)}, {"threads", to_string(threads)}};
 
                 // Последовательное вычисление
-                auto startSeq = chrono::high_resolution_clock::now();
-                calculateDotProductSequential(filename, dim, n, sequentialResults);
-                auto endSeq = chrono::high_resolution_clock::now();
-                auto sequentialTime = chrono::duration<double>(endSeq - startSeq).count();
+                runner.run("pipeline_sequential", params, [&]() {
+                    sequentialResults.clear();
+                    calculateDotProductSequential(filename, dim, n, sequentialResults);
+                });
+
                 omp_set_num_threads(threads);
-                auto startPar = chrono::high_resolution_clock::now();
-                // Параллельное выполнение
-                #pragma omp parallel sections
-                {
-                    #pragma omp section
-                    {
-                        readVectorsPairwise(filename, dim);
-                    }
+                BenchmarkStats parallelStats = runner.run("pipeline_parallel", params, [&]() {
+                    done = false;  // Сбрасываем флаг завершения
+                    parallelResults.clear();
+                    handoffLatencies.clear();
 
-                    #pragma omp section
+                    // Параллельное выполнение
+                    #pragma omp parallel sections
                     {
-                        calculateDotProduct(dim, parallelResults);
+                        #pragma omp section
+                        {
+                            readVectorsPairwise(filename, dim, input);
+                        }
+
+                        #pragma omp section
+                        {
+                            calculateDotProduct(dim, parallelResults);
+                        }
                     }
+                });
+                print_pipeline_row(n, dim, threads, "double-buffer", parallelStats, handoffLatencies,
+                                   parallelResults == sequentialResults);
+
+                // Один читатель и threads - 1 колец; при меньшей команде потоков
+                // вычислитель обслуживает несколько колец
+                vector<unique_ptr<SpscRing<VectorPairSlot>>> rings;
+                int workers = max(1, threads - 1);
+                for (int w = 0; w < workers; ++w) {
+                    rings.emplace_back(new SpscRing<VectorPairSlot>(worker_depth,
+                        VectorPairSlot{vector<int>(dim), vector<int>(dim)}));
                 }
-                auto endPar = chrono::high_resolution_clock::now();
-                auto parallelTime = chrono::duration<double>(endPar - startPar).count();
+                vector<double> workerLatencies;
+                BenchmarkParams workerParams = params;
+                workerParams.push_back({"depth", to_string(worker_depth)});
 
-                cout << n << " | " << dim << " | " << threads << " | ";
-                cout << parallelTime << " | ";
-                if (parallelResults == sequentialResults) {
-                    cout << "Match\n";
-                } else {
-                    cout << "Do not match\n";
+                // Фактическое число вычислителей: команда может быть меньше запрошенной
+                int teamWorkers = 0;
+                BenchmarkStats workerStats = runner.run("pipeline_workers", workerParams, [&]() {
+                    teamWorkers = runWorkerPipeline(filename, dim, rings, parallelResults, workerLatencies, input);
+                });
+                print_pipeline_row(n, dim, threads, "workers(" + to_string(teamWorkers) + "/" + to_string(workers) + ")",
+                                   workerStats, workerLatencies, parallelResults == sequentialResults);
+
+                if (mode != "ring") {
+                    continue;
                 }
 
-                parallelResults.clear();
-                sequentialResults.clear();
+                for (int depth : ring_depths) {
+                    // Ячейки выделяются один раз, вне замера
+                    SpscRing<VectorPairSlot> ring(depth, VectorPairSlot{vector<int>(dim), vector<int>(dim)});
+                    vector<vector<SequencedResult>> ringResults(1);
+                    vector<double> latencies;
+                    BenchmarkParams ringParams = params;
+                    ringParams.push_back({"depth", to_string(depth)});
+
+                    BenchmarkStats ringStats = runner.run("pipeline_ring", ringParams, [&]() {
+                        ring.reset();
+                        ringResults[0].clear();
+                        latencies.clear();
+
+                        #pragma omp parallel sections
+                        {
+                            #pragma omp section
+                            {
+                                readVectorsToRings(filename, dim, {&ring}, input);
+                            }
+
+                            #pragma omp section
+                            {
+                                calculateDotProductFromRing(dim, ring, ringResults[0], latencies);
+                            }
+                        }
+                    });
+                    collectInOrder(ringResults, parallelResults);
+                    print_pipeline_row(n, dim, threads, "ring(" + to_string(depth) + ")", ringStats, latencies,
+                                       parallelResults == sequentialResults);
+                }
             }
         }
     }
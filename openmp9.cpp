@@ -1,101 +1,313 @@
 #include <iostream>
 #include <omp.h>
 #include <vector>
-#include <chrono>
 #include <iomanip>
 #include <cstdlib>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include "benchmark.h"
+#include "matrix.h"
+#include "data_generator.h"
+#include "statistics.h"
 
 using namespace std;
 
-// Функция для инициализации матрицы случайными значениями
-void initialize_matrix(vector<vector<int>>& matrix, size_t rows, size_t cols) {
-    for (size_t i = 0; i < rows; ++i) {
-        for (size_t j = 0; j < cols; ++j) {
-            matrix[i][j] = rand() % 100;
-        }
-    }
+// Функция для инициализации матрицы случайными значениями от 0 до 99
+void initialize_matrix(Matrix<int>& matrix, uint64_t seed) {
+    fill_uniform_ints(matrix, 0, 99, seed);
 }
 
-// Функция для поиска максимального значения среди минимальных элементов строк (без вложенного параллелизма)
-double find_max_of_mins_no_nested_parallel(const vector<vector<int>>& matrix, int num_threads) {
+// Столбец первого вхождения value в строке i (для строки, улучшившей результат)
+size_t column_of(const Matrix<int>& matrix, size_t i, int value) {
+    RowView<const int> row = matrix.row(i);
+    return find(row.begin(), row.end(), value) - row.begin();
+}
+
+// Функция для поиска максимального значения среди минимальных элементов строк (без вложенного параллелизма).
+// Работает как с Matrix<int>, так и с прежним vector<vector<int>> (--mode=layout)
+template <typename MatrixType>
+LocatedValue<int> find_max_of_mins_no_nested_parallel(const MatrixType& matrix, int num_threads) {
     size_t rows = matrix.size();
-    size_t cols = matrix[0].size();
-    int max_of_mins = matrix[0][0];
+    size_t cols = rows > 0 ? matrix[0].size() : 0;
+    LocatedValue<int> max_of_mins;
     
     omp_set_num_threads(num_threads);
-    auto start = chrono::high_resolution_clock::now();
 
     // Параллельный цикл по строкам матрицы
-    #pragma omp parallel for reduction(max:max_of_mins)
+    #pragma omp parallel for reduction(maxloc:max_of_mins)
     for (size_t i = 0; i < rows; ++i) {
-        int min_in_row = matrix[i][0];
+        const auto& row = matrix[i];
+        int min_in_row = row[0];
+        size_t min_col = 0;
         for (size_t j = 1; j < cols; ++j) {
-            if (matrix[i][j] < min_in_row) {
-                min_in_row = matrix[i][j];
+            if (row[j] < min_in_row) {
+                min_in_row = row[j];
+                min_col = j;
             }
         }
-        max_of_mins = max(max_of_mins, min_in_row);
+        max_of_mins.offer_max(min_in_row, i, [&]() { return min_col; });
     }
-
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+    return max_of_mins;
 }
 
 // Функция для поиска максимального значения среди минимальных элементов строк (с вложенным параллелизмом)
-double find_max_of_mins_with_nested_parallel(const vector<vector<int>>& matrix, int num_threads) {
-    size_t rows = matrix.size();
-    size_t cols = matrix[0].size();
-    int max_of_mins = matrix[0][0];
+LocatedValue<int> find_max_of_mins_with_nested_parallel(const Matrix<int>& matrix, int num_threads) {
+    size_t rows = matrix.rows();
+    size_t cols = matrix.cols();
+    LocatedValue<int> max_of_mins;
     
     omp_set_num_threads(num_threads);
-    auto start = chrono::high_resolution_clock::now();
 
     // Внешний параллельный цикл по строкам матрицы
-    #pragma omp parallel for shared(matrix) reduction(max:max_of_mins)
+    #pragma omp parallel for shared(matrix) reduction(maxloc:max_of_mins)
     for (size_t i = 0; i < rows; ++i) {
-        int min_in_row = matrix[i][0];
+        RowView<const int> row = matrix.row(i);
+        int min_in_row = row[0];
 
         // Вложенный параллельный цикл по элементам строки
         #pragma omp parallel for reduction(min:min_in_row)
         for (size_t j = 1; j < cols; ++j) {
-            min_in_row = min(min_in_row, matrix[i][j]);
+            min_in_row = min(min_in_row, row[j]);
         }
         
-        max_of_mins = max(max_of_mins, min_in_row);
+        max_of_mins.offer_max(min_in_row, i, [&]() { return column_of(matrix, i, min_in_row); });
     }
+    return max_of_mins;
+}
+
+// Распределение бюджета потоков между уровнями: outer потоков по строкам и
+// inner потоков внутри каждого из них по столбцам, outer * inner <= total.
+// Если строк хватает на все потоки, второй уровень не нужен (inner = 1)
+struct ThreadBudget {
+    int outer;
+    int inner;
+};
+
+ThreadBudget split_thread_budget(int total, size_t rows, int requested_inner) {
+    int inner = requested_inner > 0 ? requested_inner
+              : (rows >= static_cast<size_t>(total) ? 1 : total / max<int>(1, static_cast<int>(rows)));
+    inner = max(1, min(inner, total));
+    return ThreadBudget{max(1, total / inner), inner};
+}
+
+// Иерархический вариант: команды обоих уровней создаются один раз за вызов,
+// а не на каждую строку. Внешний поток берёт свой блок строк, его внутренняя
+// команда делит столбцы: каждый внутренний поток считает omp simd минимумы
+// своей части столбцов для всех строк блока и пишет их в свою строку partial
+// (разные кэш-линии), после чего внешний поток сводит частичные минимумы.
+// При inner = 1 вложенной области нет, строка обходится циклом omp simd
+LocatedValue<int> find_max_of_mins_hierarchical(const Matrix<int>& matrix, ThreadBudget budget) {
+    size_t rows = matrix.rows();
+    size_t cols = matrix.cols();
+    LocatedValue<int> max_of_mins;
 
-    auto end = chrono::high_resolution_clock::now();
-    return chrono::duration<double>(end - start).count();
+    if (budget.inner == 1) {
+        #pragma omp parallel for num_threads(budget.outer) schedule(static) reduction(maxloc:max_of_mins)
+        for (size_t i = 0; i < rows; ++i) {
+            const int* row = matrix.row(i).data();
+            int min_in_row = row[0];
+            #pragma omp simd reduction(min:min_in_row)
+            for (size_t j = 1; j < cols; ++j) {
+                min_in_row = min(min_in_row, row[j]);
+            }
+            max_of_mins.offer_max(min_in_row, i, [&]() { return column_of(matrix, i, min_in_row); });
+        }
+        return max_of_mins;
+    }
+
+    Matrix<int> partial(budget.inner, rows, numeric_limits<int>::max());
+
+    #pragma omp parallel num_threads(budget.outer) reduction(maxloc:max_of_mins)
+    {
+        int outer_id = omp_get_thread_num();
+        int outer_team = omp_get_num_threads();
+        size_t row_begin = rows * outer_id / outer_team;
+        size_t row_end = rows * (outer_id + 1) / outer_team;
+
+        #pragma omp parallel num_threads(budget.inner)
+        {
+            int inner_id = omp_get_thread_num();
+            int inner_team = omp_get_num_threads();
+            size_t col_begin = cols * inner_id / inner_team;
+            size_t col_end = cols * (inner_id + 1) / inner_team;
+            RowView<int> my_partial = partial.row(inner_id);
+
+            for (size_t i = row_begin; i < row_end; ++i) {
+                const int* row = matrix.row(i).data();
+                int min_in_slice = numeric_limits<int>::max();
+                #pragma omp simd reduction(min:min_in_slice)
+                for (size_t j = col_begin; j < col_end; ++j) {
+                    min_in_slice = min(min_in_slice, row[j]);
+                }
+                my_partial[i] = min_in_slice;
+            }
+        }
+
+        for (size_t i = row_begin; i < row_end; ++i) {
+            int min_in_row = numeric_limits<int>::max();
+            for (int t = 0; t < budget.inner; ++t) {
+                min_in_row = min(min_in_row, partial(t, i));
+            }
+            max_of_mins.offer_max(min_in_row, i, [&]() { return column_of(matrix, i, min_in_row); });
+        }
+    }
+    return max_of_mins;
 }
 
-int main() {
+// Двухуровневое разбиение без вложенных команд: пространство итераций
+// (строка, блок из block_cols столбцов) сворачивается в один цикл collapse(2),
+// поэтому широкая матрица с малым числом строк всё равно делится на все
+// потоки. Минимумы блоков складываются в block_mins, затем сводятся по строкам
+LocatedValue<int> find_max_of_mins_blocked(const Matrix<int>& matrix, int num_threads, size_t block_cols) {
+    size_t rows = matrix.rows();
+    size_t cols = matrix.cols();
+    size_t blocks = (cols + block_cols - 1) / block_cols;
+    Matrix<int> block_mins(rows, blocks);
+    LocatedValue<int> max_of_mins;
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        #pragma omp for collapse(2) schedule(static)
+        for (size_t i = 0; i < rows; ++i) {
+            for (size_t b = 0; b < blocks; ++b) {
+                const int* row = matrix.row(i).data();
+                size_t begin = b * block_cols;
+                size_t end = min(cols, begin + block_cols);
+                int min_in_block = row[begin];
+                #pragma omp simd reduction(min:min_in_block)
+                for (size_t j = begin + 1; j < end; ++j) {
+                    min_in_block = min(min_in_block, row[j]);
+                }
+                block_mins(i, b) = min_in_block;
+            }
+        }
+
+        // Столбец ищется только в блоке, где лежит минимум строки
+        #pragma omp for schedule(static) reduction(maxloc:max_of_mins)
+        for (size_t i = 0; i < rows; ++i) {
+            RowView<int> row_blocks = block_mins.row(i);
+            int* min_block = min_element(row_blocks.begin(), row_blocks.end());
+            max_of_mins.offer_max(*min_block, i, [&]() {
+                const int* row = matrix.row(i).data();
+                size_t begin = (min_block - row_blocks.begin()) * block_cols;
+                return find(row + begin, row + min(cols, begin + block_cols), *min_block) - row;
+            });
+        }
+    }
+    return max_of_mins;
+}
+
+// Результат в виде "value @ (row, col)"
+string format_result(const LocatedValue<int>& result) {
+    return to_string(result.value) + " @ (" + to_string(result.row) + ", " + to_string(result.col) + ")";
+}
+
+// Форма матрицы "RxC"
+bool parse_shape(const string& text, size_t& rows, size_t& cols) {
+    size_t x = text.find('x');
+    if (x == string::npos) return false;
+    return parse_positive(text.substr(0, x), rows) && parse_positive(text.substr(x + 1), cols);
+}
+
+// Сравнение Matrix<int> с прежним хранением vector<vector<int>> на варианте
+// без вложенного параллелизма (--mode=layout)
+void compare_layouts(BenchmarkRunner& runner, const string& shape, const Matrix<int>& matrix,
+                     const vector<int>& thread_counts) {
+    vector<vector<int>> nested(matrix.rows());
+    for (size_t i = 0; i < matrix.rows(); ++i) {
+        nested[i].assign(matrix[i].begin(), matrix[i].end());
+    }
+
+    for (int num_threads : thread_counts) {
+        LocatedValue<int> flat_result, nested_result;
+        double flat_time = runner.run("max_of_mins_layout",
+            {{"shape", shape}, {"threads", to_string(num_threads)}, {"layout", "flat"}}, [&]() {
+            flat_result = find_max_of_mins_no_nested_parallel(matrix, num_threads);
+        }).median;
+        double nested_time = runner.run("max_of_mins_layout",
+            {{"shape", shape}, {"threads", to_string(num_threads)}, {"layout", "nested"}}, [&]() {
+            nested_result = find_max_of_mins_no_nested_parallel(nested, num_threads);
+        }).median;
+
+        bool same = flat_result.value == nested_result.value && flat_result.row == nested_result.row &&
+                    flat_result.col == nested_result.col;
+        cout << fixed << setprecision(6);
+        cout << "Flat Matrix<int>           | " << num_threads << "              | " << shape << "         | " << flat_time << " | " << format_result(flat_result) << "\n";
+        cout << "Nested vector<vector<int>> | " << num_threads << "              | " << shape << "         | " << nested_time << " | " << format_result(nested_result)
+             << (same ? "" : " MISMATCH") << " (x" << setprecision(3) << nested_time / flat_time << ")\n";
+        cout << "--------------------------------------------------------------\n";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    BenchmarkRunner runner("openmp9", parse_benchmark_options(argc, argv));
+
     const vector<int> thread_counts = {2, 4, 8, 16};
-    const vector<int> matrix_sizes = {100, 500, 1000};
-    
-    // Включаем вложенный параллелизм
-    omp_set_nested(1);
-
-    // Проверяем, включен ли вложенный параллелизм
-    if (omp_get_nested()) {
-        cout << "Nested parallelism is enabled." << endl;
-    } else {
-        cout << "Nested parallelism is not enabled." << endl;
+    // --shapes=RxC,...: квадратные матрицы и широкие (мало строк, много столбцов)
+    const vector<string> shapes = parse_string_list(get_option(argc, argv, "shapes", "100x100,500x500,1000x1000,4x250000"));
+    // --inner=N: потоков второго уровня (по умолчанию - из числа строк)
+    const int requested_inner = stoi(get_option(argc, argv, "inner", "0"));
+    // --block-cols=N: ширина блока столбцов варианта collapse(2), N >= 1
+    const string block_cols_option = get_option(argc, argv, "block-cols", "4096");
+    size_t block_cols = 0;
+    if (!parse_positive(block_cols_option, block_cols)) {
+        cerr << "Invalid block width (expected an integer >= 1): " << block_cols_option << endl;
+        return 1;
     }
+    const uint64_t seed = parse_data_seed(argc, argv);
+    // --mode=layout: плоская Matrix<int> против прежнего vector<vector<int>>
+    const bool layout_mode = get_option(argc, argv, "mode", "default") == "layout";
+    
+    // Разрешаем два активных уровня параллелизма (omp_set_nested устарел с OpenMP 5.0)
+    omp_set_max_active_levels(2);
+    cout << "Max active levels: " << omp_get_max_active_levels() << endl;
 
-    cout << "Method | Number of Threads | Matrix Size | Time (sec)\n";
+    cout << "Method | Number of Threads | Matrix Size | Median (sec) | Result\n";
     cout << "--------------------------------------------------------------\n";
 
-    // Основной цикл по размерам матрицы
-    for (int size : matrix_sizes) {
-        vector<vector<int>> matrix(size, vector<int>(size));
-        initialize_matrix(matrix, size, size);
+    // Основной цикл по формам матрицы
+    for (const string& shape : shapes) {
+        size_t rows, cols;
+        if (!parse_shape(shape, rows, cols)) {
+            cerr << "Invalid matrix shape: " << shape << endl;
+            return 1;
+        }
+        Matrix<int> matrix(rows, cols);
+        initialize_matrix(matrix, seed);
+        if (layout_mode) {
+            compare_layouts(runner, shape, matrix, thread_counts);
+            continue;
+        }
         for (int num_threads : thread_counts) {
-            double time_no_nested = find_max_of_mins_no_nested_parallel(matrix, num_threads);
-            double time_with_nested = find_max_of_mins_with_nested_parallel(matrix, num_threads);
+            BenchmarkParams params = {{"shape", shape}, {"threads", to_string(num_threads)}};
+            ThreadBudget budget = split_thread_budget(num_threads, rows, requested_inner);
+            string split = to_string(budget.outer) + "x" + to_string(budget.inner);
+            LocatedValue<int> result_no_nested;
+            LocatedValue<int> result_with_nested;
+            LocatedValue<int> result_hierarchical;
+            LocatedValue<int> result_blocked;
+
+            double time_no_nested = runner.run("max_of_mins_no_nested", params, [&]() {
+                result_no_nested = find_max_of_mins_no_nested_parallel(matrix, num_threads);
+            }).median;
+            double time_with_nested = runner.run("max_of_mins_with_nested", params, [&]() {
+                result_with_nested = find_max_of_mins_with_nested_parallel(matrix, num_threads);
+            }).median;
+            BenchmarkParams hierarchical_params = params;
+            hierarchical_params.push_back({"split", split});
+            double time_hierarchical = runner.run("max_of_mins_hierarchical", hierarchical_params, [&]() {
+                result_hierarchical = find_max_of_mins_hierarchical(matrix, budget);
+            }).median;
+            double time_blocked = runner.run("max_of_mins_blocked", params, [&]() {
+                result_blocked = find_max_of_mins_blocked(matrix, num_threads, block_cols);
+            }).median;
 
             cout << fixed << setprecision(6);
-            cout << "Without Nested Parallelism | " << num_threads << "              | " << size << "x" << size << "         | " << time_no_nested << "\n";
-            cout << "With Nested Parallelism    | " << num_threads << "              | " << size << "x" << size << "         | " << time_with_nested << "\n";
+            cout << "Without Nested Parallelism | " << num_threads << "              | " << shape << "         | " << time_no_nested << " | " << format_result(result_no_nested) << "\n";
+            cout << "With Nested Parallelism    | " << num_threads << "              | " << shape << "         | " << time_with_nested << " | " << format_result(result_with_nested) << "\n";
+            cout << "Hierarchical (" << setw(5) << split << ")     | " << num_threads << "              | " << shape << "         | " << time_hierarchical << " | " << format_result(result_hierarchical) << "\n";
+            cout << "Two-Level Blocked          | " << num_threads << "              | " << shape << "         | " << time_blocked << " | " << format_result(result_blocked) << "\n";
             cout << "--------------------------------------------------------------\n";
         }
     }
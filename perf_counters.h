@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdlib>
+
+#ifdef __linux__
+#include <cstring>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+// Аппаратные счётчики производительности через perf_event_open (только Linux).
+// Счётчики открываются для вызывающего потока, поэтому в параллельной области
+// каждый поток создаёт свой набор, а значения потоков затем суммируются.
+// Если событие недоступно (нет поддержки, perf_event_paranoid, виртуальная
+// машина), соответствующий счётчик помечается как недоступный, и программа
+// продолжает работу без него.
+
+struct PerfEventSpec {
+    std::string name;
+    uint32_t type;
+    uint64_t config;
+};
+
+// Промахи последнего уровня кэша, промахи чтения L1D и, если задан сырой код
+// события (--hitm-event=0x..., зависит от модели процессора, например
+// MEM_LOAD_L3_HIT_RETIRED.XSNP_HITM на Intel), обращения к изменённой строке
+// в кэше другого ядра (HITM) - прямой признак ложного разделения
+inline std::vector<PerfEventSpec> cache_contention_events(const std::string& hitm_event) {
+    std::vector<PerfEventSpec> events;
+#ifdef __linux__
+    events.push_back({"cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES});
+    events.push_back({"L1D-read-misses", PERF_TYPE_HW_CACHE,
+                      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)});
+    if (!hitm_event.empty()) {
+        events.push_back({"HITM", PERF_TYPE_RAW, std::strtoull(hitm_event.c_str(), nullptr, 0)});
+    }
+#else
+    (void)hitm_event;
+#endif
+    return events;
+}
+
+class PerfCounters {
+public:
+    explicit PerfCounters(const std::vector<PerfEventSpec>& events) : fds_(events.size(), -1) {
+#ifdef __linux__
+        for (size_t k = 0; k < events.size(); ++k) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = events[k].type;
+            attr.config = events[k].config;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds_[k] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+#endif
+    }
+
+    ~PerfCounters() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) close(fd);
+        }
+#endif
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    void start() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    void stop() {
+#ifdef __linux__
+        for (int fd : fds_) {
+            if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        }
+#endif
+    }
+
+    size_t size() const { return fds_.size(); }
+    bool available(size_t k) const { return fds_[k] >= 0; }
+
+    // Значение счётчика k; -1, если событие недоступно
+    long long value(size_t k) const {
+#ifdef __linux__
+        long long count = 0;
+        if (fds_[k] >= 0 && read(fds_[k], &count, sizeof(count)) == sizeof(count)) return count;
+#else
+        (void)k;
+#endif
+        return -1;
+    }
+
+private:
+    std::vector<int> fds_;
+};
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <limits>
+#include <omp.h>
+#include "benchmark.h"
+
+// Выбор распределения итераций во время выполнения: циклы пишутся один раз
+// с schedule(runtime), а тип и размер порции задаются через omp_set_schedule.
+// Имена: "static", "dynamic", "guided", "auto", с необязательным модификатором
+// "monotonic:" или "nonmonotonic:" (например, "monotonic:dynamic").
+// Без модификатора рантайм вправе считать dynamic/guided немонотонными.
+inline bool parse_omp_schedule(const std::string& name, omp_sched_t& kind) {
+    std::string base = name;
+    bool monotonic = false;
+    if (base.compare(0, 10, "monotonic:") == 0) {
+        monotonic = true;
+        base = base.substr(10);
+    } else if (base.compare(0, 13, "nonmonotonic:") == 0) {
+        base = base.substr(13);
+    }
+
+    if (base == "static") kind = omp_sched_static;
+    else if (base == "dynamic") kind = omp_sched_dynamic;
+    else if (base == "guided") kind = omp_sched_guided;
+    else if (base == "auto") kind = omp_sched_auto;
+    else return false;
+
+    // Константа omp_sched_monotonic появилась в OpenMP 5.0. libgomp объявляет
+    // её с GCC 9, хотя _OPENMP там остаётся 201511; без неё модификатор
+    // передать нельзя, и распределение остаётся на усмотрение рантайма
+#if _OPENMP >= 201811 || (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9)
+    if (monotonic) kind = static_cast<omp_sched_t>(kind | omp_sched_monotonic);
+#else
+    (void)monotonic;
+#endif
+    return true;
+}
+
+// Установка распределения для последующих циклов с schedule(runtime).
+// chunk_size <= 0 означает размер порции по умолчанию
+inline bool set_runtime_schedule(const std::string& name, int chunk_size) {
+    omp_sched_t kind;
+    if (!parse_omp_schedule(name, kind)) {
+        std::cerr << "Unknown schedule type: " << name << std::endl;
+        return false;
+    }
+    omp_set_schedule(kind, chunk_size);
+    return true;
+}
+
+// Сетка перебора: --kinds=... --chunks=... --threads=...
+struct ScheduleGrid {
+    std::vector<std::string> kinds;
+    std::vector<int> chunks;
+    std::vector<int> thread_counts;
+};
+
+inline ScheduleGrid parse_schedule_grid(int argc, char* argv[], const std::vector<int>& default_threads) {
+    ScheduleGrid grid;
+    grid.kinds = parse_string_list(get_option(argc, argv, "kinds", "static,dynamic,guided,auto"));
+    grid.chunks = parse_int_list(get_option(argc, argv, "chunks", "1,10,100"));
+
+    std::string threads;
+    for (int t : default_threads) threads += (threads.empty() ? "" : ",") + std::to_string(t);
+    grid.thread_counts = parse_int_list(get_option(argc, argv, "threads", threads));
+    return grid;
+}
+
+struct ScheduleSetting {
+    std::string kind;
+    int chunk = 0;
+    int threads = 0;
+    double median = std::numeric_limits<double>::infinity();
+};
+
+// Перебор всех сочетаний сетки для одной нагрузки. body(threads) выполняет
+// один прогон цикла с schedule(runtime). Печатает строку на каждое сочетание
+// и возвращает лучшее по медиане.
+template <typename Body>
+ScheduleSetting sweep_schedules(BenchmarkRunner& runner, const std::string& kernel, const std::string& workload,
+                                const ScheduleGrid& grid, Body&& body) {
+    ScheduleSetting best;
+    for (int threads : grid.thread_counts) {
+        for (const std::string& kind : grid.kinds) {
+            for (int chunk : grid.chunks) {
+                omp_set_num_threads(threads);
+                if (!set_runtime_schedule(kind, chunk)) continue;
+
+                BenchmarkStats stats = runner.run(kernel,
+                    {{"workload", workload}, {"threads", std::to_string(threads)},
+                     {"schedule", kind}, {"chunk", std::to_string(chunk)}}, [&]() {
+                    body(threads);
+                });
+
+                std::cout << std::setw(20) << workload << " | "
+                          << std::setw(7) << threads << " | "
+                          << std::setw(18) << kind << " | "
+                          << std::setw(6) << chunk << " | "
+                          << std::setw(12) << stats.median << " | "
+                          << std::setw(12) << stats.p95 << "\n";
+
+                if (stats.median < best.median) {
+                    best.kind = kind;
+                    best.chunk = chunk;
+                    best.threads = threads;
+                    best.median = stats.median;
+                }
+            }
+        }
+    }
+
+    std::cout << "Best for " << workload << ": schedule(" << best.kind << ", " << best.chunk << "), "
+              << best.threads << " threads, " << best.median << " s\n";
+    return best;
+}
+
+inline void print_sweep_header() {
+    std::cout << "Workload             | Threads | Schedule           | Chunk  | Median (s)   | P95 (s)\n";
+    std::cout << "------------------------------------------------------------------------------------------\n";
+}
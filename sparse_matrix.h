@@ -0,0 +1,199 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "matrix.h"
+
+// Разреженные форматы для матриц из openmp5.cpp. Все они дают row(i) -
+// непрерывный участок хранимых (ненулевых) значений строки, поэтому обход
+// строки стоит пропорционально числу ненулевых элементов, а не cols.
+// generate() строит формат сразу, без плотной матрицы rows x cols;
+// from_dense нужен только для сравнения с плотным хранением.
+
+// Ленточная матрица: строка i хранит столбцы [i - band_width, i + band_width]
+// в строке плотной матрицы шириной 2 * band_width + 1 (хранение по диагоналям)
+template <typename T>
+class BandMatrix {
+public:
+    BandMatrix(size_t rows, size_t cols, size_t band_width)
+        : rows_(rows), cols_(cols), band_width_(band_width), band_(rows, 2 * band_width + 1) {}
+
+    // Построение по плотной матрице (берутся только элементы внутри ленты)
+    static BandMatrix from_dense(const Matrix<T>& dense, size_t band_width) {
+        BandMatrix band(dense.rows(), dense.cols(), band_width);
+        for (size_t i = 0; i < band.rows(); ++i) {
+            for (size_t j = band.first_col(i); j < band.end_col(i); ++j) {
+                band(i, j) = dense(i, j);
+            }
+        }
+        return band;
+    }
+
+    // Генерация сразу в ленточном формате, без плотной матрицы:
+    // (i, j) = value(i * cols + j) - тот же номер, что у parallel_fill_rows,
+    // поэтому данные совпадают с from_dense от плотной матрицы
+    template <typename Value>
+    static BandMatrix generate(size_t rows, size_t cols, size_t band_width, Value&& value) {
+        BandMatrix band(rows, cols, band_width);
+        long long count = static_cast<long long>(rows);
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < count; ++i) {
+            for (size_t j = band.first_col(i); j < band.end_col(i); ++j) {
+                band(i, j) = value(static_cast<uint64_t>(i) * cols + j);
+            }
+        }
+        return band;
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t size() const { return rows_; }
+
+    // Первый и следующий за последним столбцы ленты в строке i
+    size_t first_col(size_t i) const { return i > band_width_ ? i - band_width_ : 0; }
+    size_t end_col(size_t i) const { return std::min(cols_, i + band_width_ + 1); }
+
+    T& operator()(size_t i, size_t j) { return band_(i, j + band_width_ - i); }
+    const T& operator()(size_t i, size_t j) const { return band_(i, j + band_width_ - i); }
+
+    RowView<const T> row(size_t i) const {
+        size_t first = first_col(i);
+        size_t end = end_col(i);
+        return RowView<const T>(&(*this)(i, first), end > first ? end - first : 0);
+    }
+
+    size_t memory_bytes() const { return band_.rows() * band_.stride() * sizeof(T); }
+
+private:
+    size_t rows_;
+    size_t cols_;
+    size_t band_width_;
+    Matrix<T> band_;
+};
+
+// Упакованная нижнетреугольная матрица: строка i (i + 1 элемент) начинается
+// со смещения i * (i + 1) / 2
+template <typename T>
+class PackedLowerTriangular {
+public:
+    PackedLowerTriangular(size_t rows, size_t cols)
+        : rows_(rows), cols_(cols), values_(offset(rows), T()) {}
+
+    static PackedLowerTriangular from_dense(const Matrix<T>& dense) {
+        PackedLowerTriangular packed(dense.rows(), dense.cols());
+        for (size_t i = 0; i < packed.rows(); ++i) {
+            RowView<const T> src = dense.row(i);
+            std::copy(src.begin(), src.begin() + packed.row_length(i), packed.values_.begin() + offset(i));
+        }
+        return packed;
+    }
+
+    // Генерация сразу в упакованном формате: (i, j) = value(i * cols + j)
+    template <typename Value>
+    static PackedLowerTriangular generate(size_t rows, size_t cols, Value&& value) {
+        PackedLowerTriangular packed(rows, cols);
+        long long count = static_cast<long long>(rows);
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < count; ++i) {
+            for (size_t j = 0; j < packed.row_length(i); ++j) {
+                packed(i, j) = value(static_cast<uint64_t>(i) * cols + j);
+            }
+        }
+        return packed;
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t size() const { return rows_; }
+    size_t row_length(size_t i) const { return std::min(i + 1, cols_); }
+
+    T& operator()(size_t i, size_t j) { return values_[offset(i) + j]; }
+    const T& operator()(size_t i, size_t j) const { return values_[offset(i) + j]; }
+
+    RowView<const T> row(size_t i) const { return RowView<const T>(values_.data() + offset(i), row_length(i)); }
+
+    size_t memory_bytes() const { return values_.size() * sizeof(T); }
+
+private:
+    static size_t offset(size_t i) { return i * (i + 1) / 2; }
+
+    size_t rows_;
+    size_t cols_;
+    std::vector<T> values_;
+};
+
+// Формат CSR (compressed sparse row): значения и номера столбцов ненулевых
+// элементов подряд, row_ptr[i]..row_ptr[i + 1] - диапазон строки i
+template <typename T>
+class CsrMatrix {
+public:
+    static CsrMatrix from_dense(const Matrix<T>& dense) {
+        CsrMatrix csr;
+        csr.rows_ = dense.rows();
+        csr.cols_ = dense.cols();
+        csr.row_ptr_.reserve(csr.rows_ + 1);
+        csr.row_ptr_.push_back(0);
+        for (size_t i = 0; i < dense.rows(); ++i) {
+            for (size_t j = 0; j < dense.cols(); ++j) {
+                if (dense(i, j) != T()) {
+                    csr.values_.push_back(dense(i, j));
+                    csr.col_idx_.push_back(static_cast<int>(j));
+                }
+            }
+            csr.row_ptr_.push_back(csr.values_.size());
+        }
+        return csr;
+    }
+
+    // Генерация сразу в CSR: строка i занимает столбцы [first_col(i), end_col(i)),
+    // (i, j) = value(i * cols + j). Значения должны быть ненулевыми - иначе
+    // результат разойдётся с from_dense, который нули пропускает
+    template <typename First, typename End, typename Value>
+    static CsrMatrix generate(size_t rows, size_t cols, First&& first_col, End&& end_col, Value&& value) {
+        CsrMatrix csr;
+        csr.rows_ = rows;
+        csr.cols_ = cols;
+        csr.row_ptr_.assign(rows + 1, 0);
+        for (size_t i = 0; i < rows; ++i) {
+            csr.row_ptr_[i + 1] = csr.row_ptr_[i] + (end_col(i) - first_col(i));
+        }
+        csr.values_.resize(csr.row_ptr_[rows]);
+        csr.col_idx_.resize(csr.row_ptr_[rows]);
+
+        long long count = static_cast<long long>(rows);
+        #pragma omp parallel for schedule(static)
+        for (long long i = 0; i < count; ++i) {
+            size_t k = csr.row_ptr_[i];
+            for (size_t j = first_col(i); j < end_col(i); ++j, ++k) {
+                csr.values_[k] = value(static_cast<uint64_t>(i) * cols + j);
+                csr.col_idx_[k] = static_cast<int>(j);
+            }
+        }
+        return csr;
+    }
+
+    size_t rows() const { return rows_; }
+    size_t cols() const { return cols_; }
+    size_t size() const { return rows_; }
+    size_t nonzeros() const { return values_.size(); }
+
+    RowView<const T> row(size_t i) const {
+        return RowView<const T>(values_.data() + row_ptr_[i], row_ptr_[i + 1] - row_ptr_[i]);
+    }
+    RowView<const int> row_columns(size_t i) const {
+        return RowView<const int>(col_idx_.data() + row_ptr_[i], row_ptr_[i + 1] - row_ptr_[i]);
+    }
+
+    size_t memory_bytes() const {
+        return values_.size() * sizeof(T) + col_idx_.size() * sizeof(int) + row_ptr_.size() * sizeof(size_t);
+    }
+
+private:
+    size_t rows_ = 0;
+    size_t cols_ = 0;
+    std::vector<T> values_;
+    std::vector<int> col_idx_;
+    std::vector<size_t> row_ptr_;
+};
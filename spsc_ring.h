@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cassert>
+#include <thread>
+
+// Ограниченное кольцо "один писатель - один читатель" без блокировок.
+// Все ячейки создаются заранее, а передаётся только право владения ячейкой.
+// Писатель заполняет ячейку на месте (acquire_write/commit_write), а читатель
+// обрабатывает её на месте (acquire_read/release_read). Поэтому передача не
+// требует выделений памяти и системных вызовов. Писатель может опережать
+// читателя на depth ячеек. Индексы head_/tail_ растут монотонно и лежат на
+// разных кэш-линиях, чтобы писатель и читатель не мешали друг другу.
+template <typename T>
+class SpscRing {
+public:
+    // depth >= 1: в кольце без ячеек писатель ждал бы свободную ячейку вечно
+    SpscRing(size_t depth, const T& prototype = T()) : slots_(depth, prototype), head_(0), tail_(0), closed_(false) {
+        assert(depth > 0);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t depth() const { return slots_.size(); }
+
+    // Повторное использование кольца (ячейки сохраняются); только когда
+    // ни писатель, ни читатель с ним не работают
+    void reset() {
+        head_.store(0, std::memory_order_relaxed);
+        tail_.store(0, std::memory_order_relaxed);
+        closed_.store(false, std::memory_order_relaxed);
+    }
+
+    // Писатель: свободная ячейка для заполнения (ожидает, пока кольцо полно)
+    T& acquire_write() {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        while (tail - head_.load(std::memory_order_acquire) >= slots_.size()) {
+            std::this_thread::yield();
+        }
+        return slots_[tail % slots_.size()];
+    }
+
+    // Писатель: ячейка заполнена и становится видна читателю
+    void commit_write() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Писатель: данных больше не будет
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // Читатель: следующая заполненная ячейка или nullptr, если кольцо закрыто
+    // и все ячейки обработаны
+    T* acquire_read() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        while (tail_.load(std::memory_order_acquire) == head) {
+            if (closed_.load(std::memory_order_acquire) && tail_.load(std::memory_order_acquire) == head) {
+                return nullptr;
+            }
+            std::this_thread::yield();
+        }
+        return &slots_[head % slots_.size()];
+    }
+
+    // Читатель: следующая заполненная ячейка или nullptr, если её пока нет;
+    // не ждёт, поэтому один поток может опрашивать несколько колец
+    T* try_acquire_read() {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (tail_.load(std::memory_order_acquire) == head) return nullptr;
+        return &slots_[head % slots_.size()];
+    }
+
+    // Читатель: кольцо закрыто и все его ячейки обработаны
+    bool drained() const {
+        return closed_.load(std::memory_order_acquire) &&
+               tail_.load(std::memory_order_acquire) == head_.load(std::memory_order_relaxed);
+    }
+
+    // Читатель: ячейка обработана и возвращается писателю
+    void release_read() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    std::vector<T> slots_;
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+    alignas(64) std::atomic<bool> closed_;
+};
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <omp.h>
+
+// Статистики массива за один проход: минимум и максимум с индексами, сумма,
+// среднее, сумма квадратов отклонений от среднего (M2) и число элементов.
+// merge объединяет статистики двух
+// непересекающихся частей массива (состояние - моноид с нейтральным элементом
+// FusedStatistics()), поэтому структура служит пользовательской редукцией
+// OpenMP (declare reduction) и так же сливает статистики блоков, потоков
+// или разных массивов.
+//
+// Массив обрабатывается блоками, которые помещаются в L1: по блоку идёт один
+// цикл omp simd со встроенными редукциями min, max и +, а индекс экстремума
+// ищется повторным просмотром блока (уже в кэше), только если блок улучшает
+// текущий экстремум. При равных значениях выигрывает меньший индекс, поэтому
+// argmin и argmax не зависят от числа потоков и разбиения на блоки.
+//
+// Дисперсия не считается как sum_squares / n - mean^2: при большом среднем
+// и малом разбросе эта разность теряет все значащие цифры. M2 блока
+// считается вторым проходом по блоку (уже в кэше) от его среднего, а блоки
+// и потоки сливаются формулой Чана:
+//   delta = mean_b - mean_a, M2 = M2_a + M2_b + delta^2 * n_a * n_b / n.
+// Сумма остаётся отдельно: для целых данных до 2^53 она точна.
+const size_t statistics_block_size = 2048;
+
+template <typename T>
+struct FusedStatistics {
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    size_t count = 0;
+    T min = std::numeric_limits<T>::max();
+    T max = std::numeric_limits<T>::lowest();
+    size_t argmin = npos;
+    size_t argmax = npos;
+    double sum = 0.0;
+    double running_mean = 0.0;
+    double m2 = 0.0;  // Сумма квадратов отклонений от среднего
+
+    double mean() const { return running_mean; }
+    double variance() const { return count > 0 ? m2 / count : 0.0; }
+
+    // Добавление элементов data[begin, end), следующих за уже учтёнными
+    void add_block(const T* data, size_t begin, size_t end) {
+        if (begin >= end) return;
+        T block_min = data[begin];
+        T block_max = data[begin];
+        double block_sum = 0.0;
+
+        #pragma omp simd reduction(min:block_min) reduction(max:block_max) reduction(+:block_sum)
+        for (size_t i = begin; i < end; ++i) {
+            T value = data[i];
+            block_min = std::min(block_min, value);
+            block_max = std::max(block_max, value);
+            block_sum += value;
+        }
+
+        double block_mean = block_sum / (end - begin);
+        double block_m2 = 0.0;
+        #pragma omp simd reduction(+:block_m2)
+        for (size_t i = begin; i < end; ++i) {
+            double deviation = data[i] - block_mean;
+            block_m2 += deviation * deviation;
+        }
+
+        FusedStatistics block;
+        block.count = end - begin;
+        block.min = block_min;
+        block.max = block_max;
+        block.sum = block_sum;
+        block.running_mean = block_mean;
+        block.m2 = block_m2;
+        if (block_min < min || (block_min == min && begin < argmin)) {
+            block.argmin = std::find(data + begin, data + end, block_min) - data;
+        }
+        if (block_max > max || (block_max == max && begin < argmax)) {
+            block.argmax = std::find(data + begin, data + end, block_max) - data;
+        }
+        merge(block);
+    }
+
+    void merge(const FusedStatistics& other) {
+        if (other.count == 0) return;
+        if (other.min < min || (other.min == min && other.argmin < argmin)) {
+            min = other.min;
+            argmin = other.argmin;
+        }
+        if (other.max > max || (other.max == max && other.argmax < argmax)) {
+            max = other.max;
+            argmax = other.argmax;
+        }
+        size_t total = count + other.count;
+        double delta = other.running_mean - running_mean;
+        double weight = static_cast<double>(other.count) / total;
+        running_mean += delta * weight;
+        m2 += other.m2 + delta * delta * count * weight;
+        count = total;
+        sum += other.sum;
+    }
+};
+
+// Все статистики массива за один проход на threads потоках. Каждый поток
+// накапливает свою копию по блокам, копии сливаются редукцией merge
+template <typename T>
+FusedStatistics<T> compute_statistics(const T* data, size_t n, int threads) {
+    #pragma omp declare reduction(merge : FusedStatistics<T> : omp_out.merge(omp_in)) \
+        initializer(omp_priv = FusedStatistics<T>())
+
+    FusedStatistics<T> stats;
+    long long blocks = static_cast<long long>((n + statistics_block_size - 1) / statistics_block_size);
+
+    #pragma omp parallel for num_threads(threads) if(threads > 1) schedule(static) reduction(merge : stats)
+    for (long long b = 0; b < blocks; ++b) {
+        size_t begin = b * statistics_block_size;
+        stats.add_block(data, begin, std::min(n, begin + statistics_block_size));
+    }
+    return stats;
+}
+
+// Значение с его позицией в матрице (строка, столбец) - состояние редукций
+// с индексом. Из равных значений выигрывает меньшая строка, поэтому позиция
+// не зависит от числа потоков и распределения итераций. Столбец внутри строки
+// выбирает вызывающий код (обычно первое вхождение значения).
+//
+// Значение строки считается тем же циклом, что и без позиции (например,
+// omp simd по строке), а столбец вычисляется лениво - только если строка
+// улучшает текущий результат, повторным просмотром строки, которая ещё в
+// кэше. Поэтому отслеживание позиции почти ничего не стоит сверх поиска
+// одного значения
+template <typename T>
+struct LocatedValue {
+    static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+    T value = std::numeric_limits<T>::lowest();
+    size_t row = npos;
+    size_t col = npos;
+
+    // Кандидат для поиска максимума; column() вызывается, только если он лучше
+    template <typename Column>
+    void offer_max(T candidate, size_t candidate_row, Column&& column) {
+        if (candidate > value || (candidate == value && candidate_row < row)) {
+            value = candidate;
+            row = candidate_row;
+            col = column();
+        }
+    }
+
+    // Слияние частичных результатов поиска максимума
+    void merge_max(const LocatedValue& other) {
+        if (other.value > value || (other.value == value && other.row < row)) {
+            *this = other;
+        }
+    }
+};
+
+// Редукция reduction(maxloc : ...) - поиск максимума с позицией для типов,
+// которые используют программы. Объявление пользовательской редукции
+// относится к конкретному типу, поэтому каждый тип объявляется отдельно
+#pragma omp declare reduction(maxloc : LocatedValue<double> : omp_out.merge_max(omp_in)) \
+    initializer(omp_priv = LocatedValue<double>())
+#pragma omp declare reduction(maxloc : LocatedValue<int> : omp_out.merge_max(omp_in)) \
+    initializer(omp_priv = LocatedValue<int>())
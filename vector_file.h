@@ -0,0 +1,342 @@
+#pragma once
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <cstring>
+#include <charconv>
+#include <omp.h>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Двоичный формат файла векторов: заголовок и затем count * dim элементов
+// подряд, без разделителей. Файл отображается в память (mmap / MapViewOfFile),
+// и вычисления читают элементы прямо со страниц отображения, без разбора
+// текста и без копирования в промежуточные буферы.
+
+enum VectorElementType : uint32_t {
+    VectorElementInt32 = 1
+};
+
+// 32 байта: данные после заголовка выровнены для любых элементов до 8 байт
+struct VectorFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;
+    uint64_t dim;
+    uint32_t element_type;
+    uint32_t reserved;
+};
+
+const char vector_file_magic[4] = {'V', 'E', 'C', 'B'};
+const uint32_t vector_file_version = 1;
+
+inline VectorFileHeader make_vector_file_header(uint64_t count, uint64_t dim) {
+    VectorFileHeader header;
+    std::memcpy(header.magic, vector_file_magic, sizeof(header.magic));
+    header.version = vector_file_version;
+    header.count = count;
+    header.dim = dim;
+    header.element_type = VectorElementInt32;
+    header.reserved = 0;
+    return header;
+}
+
+// Запись count векторов длины dim из data в двоичный файл
+inline bool write_binary_vectors(const std::string& filename, const std::vector<int32_t>& data, uint64_t dim) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open() || dim == 0) {
+        std::cerr << "Failed to open file for writing!" << std::endl;
+        return false;
+    }
+
+    VectorFileHeader header = make_vector_file_header(data.size() / dim, dim);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(data.data()), header.count * dim * sizeof(int32_t));
+    return static_cast<bool>(file);
+}
+
+// Запись count векторов длины dim в текстовом формате (числа через пробел,
+// вектор на строке). Строки форматируются параллельно пачками по
+// batch_lines строк и пишутся в файл по порядку; value(k) - элемент номер
+// k = i * dim + j. Результат не зависит от числа потоков
+template <typename Value>
+bool write_text_vectors_parallel(const std::string& filename, size_t count, size_t dim, Value&& value,
+                                 size_t batch_lines = 256) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open file for writing!" << std::endl;
+        return false;
+    }
+
+    std::vector<std::string> lines(batch_lines);
+    for (size_t first = 0; first < count; first += batch_lines) {
+        long long batch = static_cast<long long>(std::min(batch_lines, count - first));
+
+        #pragma omp parallel for schedule(static)
+        for (long long b = 0; b < batch; ++b) {
+            std::string& line = lines[b];
+            line.clear();
+            char number[16];
+            uint64_t base = (first + b) * dim;
+            for (size_t j = 0; j < dim; ++j) {
+                std::to_chars_result result = std::to_chars(number, number + sizeof(number), value(base + j));
+                line.append(number, result.ptr);
+                line.push_back(' ');
+            }
+            line.push_back('\n');
+        }
+
+        for (long long b = 0; b < batch; ++b) {
+            file.write(lines[b].data(), lines[b].size());
+        }
+    }
+    return static_cast<bool>(file);
+}
+
+inline bool is_vector_separator(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
+
+// Разбор целых чисел, разделённых пробельными символами, из [begin, end)
+inline bool parse_integers(const char* begin, const char* end, std::vector<int32_t>& values) {
+    const char* p = begin;
+    while (true) {
+        while (p < end && is_vector_separator(*p)) ++p;
+        if (p == end) return true;
+        int32_t value;
+        std::from_chars_result result = std::from_chars(p, end, value);
+        if (result.ec != std::errc()) return false;
+        values.push_back(value);
+        p = result.ptr;
+    }
+}
+
+// Быстрое чтение текстового файла векторов: файл читается блоками по
+// block_size байт, блок обрезается по последнему переводу строки и делится на
+// num_threads частей по границам строк, части разбираются параллельно через
+// std::from_chars (без потоков ввода и локали). Разобранные числа
+// склеиваются в исходном порядке, и consume(data, vectors) получает каждый
+// раз целое число векторов длины dim - следующий этап может начинать работу,
+// не дожидаясь конца файла. Возвращает false при ошибке чтения или разбора
+template <typename Consumer>
+bool read_text_vectors_parallel(const std::string& filename, size_t dim, int num_threads, Consumer&& consume,
+                                size_t block_size = 16 << 20) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open() || dim == 0) {
+        std::cerr << "Failed to open file!" << std::endl;
+        return false;
+    }
+    if (num_threads < 1) num_threads = 1;
+
+    // Для небольших файлов блок не больше самого файла
+    file.seekg(0, std::ios::end);
+    size_t file_size = static_cast<size_t>(file.tellg());
+    file.seekg(0, std::ios::beg);
+    block_size = std::max<size_t>(1, std::min(block_size, file_size));
+
+    std::vector<char> block;
+    std::vector<std::vector<int32_t>> chunk_values(num_threads);
+    std::vector<int32_t> pending;  // Разобранные числа, ещё не составившие целый вектор
+    size_t carry = 0;              // Байты незавершённой строки из конца прошлого блока
+    bool parsed = true;
+
+    while (true) {
+        block.resize(carry + block_size);
+        file.read(block.data() + carry, block_size);
+        size_t length = carry + static_cast<size_t>(file.gcount());
+        bool last = length < block.size();
+
+        // Граница блока - после последнего перевода строки (последний блок - целиком)
+        size_t cut = length;
+        if (!last) {
+            while (cut > 0 && block[cut - 1] != '\n') --cut;
+            if (cut == 0) cut = length;  // Строка длиннее блока: делим по пробелу ниже
+            while (cut > 0 && !is_vector_separator(block[cut - 1])) --cut;
+        }
+
+        // Деление [0, cut) на части по пробельным символам
+        std::vector<size_t> bounds(num_threads + 1, cut);
+        bounds[0] = 0;
+        for (int c = 1; c < num_threads; ++c) {
+            size_t b = std::max(bounds[c - 1], cut * c / num_threads);
+            while (b < cut && !is_vector_separator(block[b])) ++b;
+            bounds[c] = b;
+        }
+
+        #pragma omp parallel for num_threads(num_threads) schedule(static, 1)
+        for (int c = 0; c < num_threads; ++c) {
+            chunk_values[c].clear();
+            if (!parse_integers(block.data() + bounds[c], block.data() + bounds[c + 1], chunk_values[c])) {
+                #pragma omp atomic write
+                parsed = false;
+            }
+        }
+        if (!parsed) {
+            std::cerr << "Failed to parse vector file!" << std::endl;
+            return false;
+        }
+
+        for (const std::vector<int32_t>& values : chunk_values) {
+            pending.insert(pending.end(), values.begin(), values.end());
+        }
+        size_t vectors = pending.size() / dim;
+        if (vectors > 0) {
+            consume(static_cast<const int32_t*>(pending.data()), vectors);
+            pending.erase(pending.begin(), pending.begin() + vectors * dim);
+        }
+
+        if (last) break;
+        carry = length - cut;
+        std::memmove(block.data(), block.data() + cut, carry);
+    }
+    return true;
+}
+
+// Преобразование текстового файла (числа через пробел, dim чисел на вектор)
+// в двоичный формат. Текст разбирается блоками read_text_vectors_parallel, и
+// каждый блок сразу дописывается в файл - память не растёт с размером входа.
+// Число векторов в заголовок пишется в конце. Неполный последний вектор
+// отбрасывается
+inline bool convert_text_to_binary(const std::string& text_filename, const std::string& binary_filename, uint64_t dim) {
+    std::ofstream file(binary_filename, std::ios::binary);
+    if (!file.is_open() || dim == 0) {
+        std::cerr << "Failed to open file for writing!" << std::endl;
+        return false;
+    }
+
+    VectorFileHeader header = make_vector_file_header(0, dim);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    bool parsed = read_text_vectors_parallel(text_filename, dim, omp_get_max_threads(),
+                                             [&](const int32_t* data, size_t vectors) {
+        file.write(reinterpret_cast<const char*>(data), vectors * dim * sizeof(int32_t));
+        header.count += vectors;
+    });
+    if (!parsed) return false;
+
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    return static_cast<bool>(file);
+}
+
+// Двоичный файл векторов, отображённый в память только для чтения
+class MappedVectorFile {
+public:
+    MappedVectorFile() = default;
+    ~MappedVectorFile() { close(); }
+
+    MappedVectorFile(const MappedVectorFile&) = delete;
+    MappedVectorFile& operator=(const MappedVectorFile&) = delete;
+
+    bool open(const std::string& filename) {
+        close();
+#ifdef _WIN32
+        file_ = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return fail("Failed to open file!");
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(file_, &size)) return fail("Failed to get file size!");
+        size_ = static_cast<size_t>(size.QuadPart);
+        if (size_ < sizeof(VectorFileHeader)) return fail("Vector file is too small!");
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_ == nullptr) return fail("Failed to map file!");
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        if (data_ == nullptr) return fail("Failed to map file!");
+#else
+        fd_ = ::open(filename.c_str(), O_RDONLY);
+        if (fd_ < 0) return fail("Failed to open file!");
+        struct stat info;
+        if (fstat(fd_, &info) != 0) return fail("Failed to get file size!");
+        size_ = static_cast<size_t>(info.st_size);
+        if (size_ < sizeof(VectorFileHeader)) return fail("Vector file is too small!");
+        void* data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (data == MAP_FAILED) return fail("Failed to map file!");
+        data_ = static_cast<const char*>(data);
+        // Файл читается подряд: ядро может заранее подкачивать страницы
+        madvise(data, size_, MADV_SEQUENTIAL);
+#endif
+        std::memcpy(&header_, data_, sizeof(header_));
+        if (std::memcmp(header_.magic, vector_file_magic, sizeof(header_.magic)) != 0 ||
+            header_.version != vector_file_version || header_.element_type != VectorElementInt32) {
+            return fail("Unsupported vector file format!");
+        }
+        if (sizeof(VectorFileHeader) + header_.count * header_.dim * sizeof(int32_t) > size_) {
+            return fail("Vector file is truncated!");
+        }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data_ != nullptr) UnmapViewOfFile(data_);
+        if (mapping_ != nullptr) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_ != nullptr) munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    size_t count() const { return data_ ? header_.count : 0; }
+    size_t dim() const { return data_ ? header_.dim : 0; }
+
+    // Вектор номер i - указатель прямо на страницы отображения
+    const int32_t* vector(size_t i) const {
+        return reinterpret_cast<const int32_t*>(data_ + sizeof(VectorFileHeader)) + i * header_.dim;
+    }
+
+    // Векторы [begin, end) больше не нужны: их страницы возвращаются системе,
+    // и потоковый проход по большому файлу не накапливает резидентную память.
+    // Освобождаются только страницы, целиком лежащие в диапазоне; повторное
+    // обращение снова подкачает их из файла
+    void release(size_t begin, size_t end) const {
+#ifndef _WIN32
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t first = sizeof(VectorFileHeader) + begin * header_.dim * sizeof(int32_t);
+        size_t last = sizeof(VectorFileHeader) + end * header_.dim * sizeof(int32_t);
+        first = (first + page - 1) / page * page;
+        last = last / page * page;
+        if (data_ != nullptr && first < last) {
+            madvise(const_cast<char*>(data_) + first, last - first, MADV_DONTNEED);
+        }
+#else
+        (void)begin;
+        (void)end;
+#endif
+    }
+
+private:
+    bool fail(const char* message) {
+        std::cerr << message << std::endl;
+        close();
+        return false;
+    }
+
+    VectorFileHeader header_ = {};
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <thread>
+#include <omp.h>
+#include "counter_rng.h"
+
+// Исполнитель параллельного цикла с перехватом работы (work stealing).
+// У каждого потока своя двусторонняя очередь Chase-Lev с диапазонами
+// итераций: владелец берёт работу с "дна" без атомарных RMW-операций в
+// обычном случае, а простаивающие потоки крадут с "вершины" очереди
+// случайно выбранной жертвы. В отличие от schedule(dynamic) нет общего
+// счётчика итераций, за который конкурируют все потоки.
+
+// Диапазон итераций [begin, end), упакованный в 64 бита, чтобы ячейка
+// очереди читалась и писалась одной атомарной операцией
+struct IterationRange {
+    int begin;
+    int end;
+
+    uint64_t pack() const { return (static_cast<uint64_t>(static_cast<uint32_t>(begin)) << 32) | static_cast<uint32_t>(end); }
+    static IterationRange unpack(uint64_t value) {
+        return IterationRange{static_cast<int>(value >> 32), static_cast<int>(value & 0xFFFFFFFFu)};
+    }
+};
+
+// Очередь Chase-Lev фиксированной ёмкости (Lê, Pop, Cohen, Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models", 2013).
+// push/pop вызывает только владелец, steal - любые потоки.
+class WorkStealingDeque {
+public:
+    // Диапазоны делятся пополам, поэтому в очереди не больше ~log2(n) элементов
+    static const int64_t capacity = 64;
+
+    WorkStealingDeque() : top_(0), bottom_(0) {
+        for (int64_t i = 0; i < capacity; ++i) buffer_[i].store(0, std::memory_order_relaxed);
+    }
+
+    bool push(IterationRange range) {
+        int64_t b = bottom_.load(std::memory_order_relaxed);
+        int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t >= capacity) return false;
+        buffer_[b & (capacity - 1)].store(range.pack(), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool pop(IterationRange& range) {
+        int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+
+        range = IterationRange::unpack(buffer_[b & (capacity - 1)].load(std::memory_order_relaxed));
+        if (t == b) {
+            // Последний элемент: соревнуемся с ворами через CAS по top
+            bool won = top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    bool steal(IterationRange& range) {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) return false;
+
+        range = IterationRange::unpack(buffer_[t & (capacity - 1)].load(std::memory_order_relaxed));
+        return top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+    alignas(64) std::atomic<uint64_t> buffer_[capacity];
+};
+
+// Параллельный цикл по [0, num_iterations) с редукцией сложением:
+// возвращает сумму body(i). Каждый поток начинает со своего статического
+// блока; перед выполнением диапазон делится пополам, пока он длиннее
+// grain, а вторая половина кладётся в очередь и доступна для кражи.
+template <typename T, typename Body>
+T work_stealing_reduce(int num_iterations, int grain, int num_threads, T init, Body&& body) {
+    if (grain < 1) grain = 1;
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques;
+    for (int t = 0; t < num_threads; ++t) {
+        deques.emplace_back(new WorkStealingDeque());
+        int begin = static_cast<int>(static_cast<long long>(num_iterations) * t / num_threads);
+        int end = static_cast<int>(static_cast<long long>(num_iterations) * (t + 1) / num_threads);
+        if (begin < end) deques[t]->push(IterationRange{begin, end});
+    }
+
+    std::atomic<int> remaining(num_iterations);
+    T result = init;
+
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int self = omp_get_thread_num();
+        uint64_t steal_counter = 0;
+        int failed_steals = 0;
+        T local = T();
+        IterationRange range;
+
+        while (remaining.load(std::memory_order_acquire) > 0) {
+            bool found = deques[self]->pop(range);
+            if (!found) {
+                // Случайная жертва; счётчиковый генератор не требует общего состояния
+                int victim = static_cast<int>(counter_random(self, steal_counter++) % num_threads);
+                found = victim != self && deques[victim]->steal(range);
+                if (!found) {
+                    // После серии неудач уступаем процессор (важно, если потоков больше, чем ядер)
+                    if (++failed_steals > 2 * num_threads) {
+                        std::this_thread::yield();
+                        failed_steals = 0;
+                    }
+                    continue;
+                }
+            }
+            failed_steals = 0;
+
+            while (range.end - range.begin > grain) {
+                int mid = range.begin + (range.end - range.begin) / 2;
+                if (!deques[self]->push(IterationRange{mid, range.end})) break;
+                range.end = mid;
+            }
+
+            for (int i = range.begin; i < range.end; ++i) {
+                local += body(i);
+            }
+            remaining.fetch_sub(range.end - range.begin, std::memory_order_acq_rel);
+        }
+
+        #pragma omp critical
+        result += local;
+    }
+
+    return result;
+}